@@ -6,13 +6,21 @@
 
   Usage:
     #define CLAY_IMPLEMENTATION
-    #include "clay.h"
     #define RENDERER_IMPLEMENTATION
-    #include "renderer.h"
+    #include "renderer.h" // Includes clay.h
 */
 
 #pragma once
 
+// POSIX functions used by the implementation (`pread`, `nanosleep`, `strnlen`) aren't declared under a strict `-std=c11`
+// without this, and it only counts before the first system header, so the implementation has to be included first
+#if defined(RENDERER_IMPLEMENTATION) && !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#if defined(__APPLE__) && !defined(_DARWIN_C_SOURCE)
+#define _DARWIN_C_SOURCE // Keeps `_SC_NPROCESSORS_ONLN` visible
+#endif
+#endif
+
 #include "clay.h"
 #include "raylib.h"
 #include "raymath.h"
@@ -22,11 +30,88 @@
 #include <math.h>
 #include <string.h>
 
+/* USDT probes for tracing live processes with bpftrace or perf, compiled in with `RENDERER_USDT` on Linux
+   (needs `sys/sdt.h` from systemtap-sdt-dev). Each probe is a single nop until a tracer attaches, ex:
+     bpftrace -e 'usdt:./app:renderer:render_command { @[arg0] = count(); }'
+*/
+#if defined(RENDERER_USDT) && defined(__linux__)
+#include <sys/sdt.h>
+#define RENDERER_PROBE(name) DTRACE_PROBE(renderer, name)
+#define RENDERER_PROBE1(name, a) DTRACE_PROBE1(renderer, name, a)
+#define RENDERER_PROBE2(name, a, b) DTRACE_PROBE2(renderer, name, a, b)
+#else
+#define RENDERER_PROBE(name)
+#define RENDERER_PROBE1(name, a)
+#define RENDERER_PROBE2(name, a, b)
+#endif
+
+/* Heap allocation checker, compiled in with `RENDERER_ALLOC_CHECK`. On glibc the implementation defines malloc, calloc,
+   realloc, the aligned allocators (posix_memalign, aligned_alloc, memalign) and free on top of `__libc_*`, which
+   interposes them for the whole process (raylib and the GL driver included) like an LD_PRELOAD shim would. Allocations
+   on the render thread are counted per frame and, past the warm-up frames, any frame that allocates through them is
+   reported with the call stacks of its first allocations. Direct mmap and sbrk calls aren't seen.
+*/
+#undef RENDERER_ALLOC_HOOKS // Only ever derived from `RENDERER_ALLOC_CHECK`, it needs the headers below
+#if defined(RENDERER_ALLOC_CHECK) && defined(__GLIBC__)
+#include <errno.h>
+#include <execinfo.h>
+#define RENDERER_ALLOC_HOOKS
+#endif
+
 #ifdef _WIN32
 #define NOGDI
 #define NOUSER
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// C11 atomics. MSVC's C mode doesn't have them, there the few operations used here map onto Interlocked and every
+// atomic is 64 bits
+#if defined(_MSC_VER) && !defined(__clang__) && !defined(__cplusplus)
+typedef volatile LONG64 atomic_bool;
+typedef volatile LONG64 atomic_int;
+typedef volatile LONG64 atomic_uint;
+typedef volatile LONG64 atomic_size_t;
+typedef volatile LONG64 atomic_uint_least64_t;
+typedef enum { memory_order_relaxed, memory_order_acquire, memory_order_release, memory_order_seq_cst } memory_order;
+
+static inline bool rendererCompareExchange(volatile LONG64 *object, LONG64 *expected, LONG64 desired) {
+  LONG64 previous = InterlockedCompareExchange64(object, desired, *expected);
+  if (previous == *expected) return true;
+  *expected = previous;
+  return false;
+}
+
+#define atomic_init(object, value) (*(object) = (LONG64)(value))
+#define atomic_load(object) InterlockedOr64((volatile LONG64 *)(object), 0)
+#define atomic_load_explicit(object, order) atomic_load(object)
+#define atomic_store(object, value) ((void)InterlockedExchange64((volatile LONG64 *)(object), (LONG64)(value)))
+#define atomic_store_explicit(object, value, order) atomic_store(object, value)
+#define atomic_exchange(object, value) InterlockedExchange64((volatile LONG64 *)(object), (LONG64)(value))
+#define atomic_fetch_add(object, value) InterlockedExchangeAdd64((volatile LONG64 *)(object), (LONG64)(value))
+#define atomic_fetch_add_explicit(object, value, order) atomic_fetch_add(object, value)
+#define atomic_compare_exchange_strong(object, expected, desired) rendererCompareExchange((volatile LONG64 *)(object), (LONG64 *)(expected), (LONG64)(desired))
+#define atomic_compare_exchange_weak_explicit(object, expected, desired, success, failure) atomic_compare_exchange_strong(object, expected, desired)
+#else
+#include <stdatomic.h>
+#endif
+
+// SSE2 kernels for chart decimation, scalar everywhere else or with `RENDERER_NO_SIMD`. Defining `RENDERER_SSE2`
+// turns them on for a compiler that doesn't announce SSE2
+#ifdef RENDERER_NO_SIMD
+#undef RENDERER_SSE2
+#elif defined(RENDERER_SSE2) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#ifndef RENDERER_SSE2
+#define RENDERER_SSE2
+#endif
 #endif
 
 /*
@@ -50,7 +135,7 @@
 
 Camera Raylib_camera;
 
-typedef enum { CUSTOM_LAYOUT_ELEMENT_TYPE_3D_MODEL } CustomLayoutElementType;
+typedef enum { CUSTOM_LAYOUT_ELEMENT_TYPE_3D_MODEL, CUSTOM_LAYOUT_ELEMENT_TYPE_TEXT_SPANS, CUSTOM_LAYOUT_ELEMENT_TYPE_GLYPH_GRID, CUSTOM_LAYOUT_ELEMENT_TYPE_PRE_TEXT, CUSTOM_LAYOUT_ELEMENT_TYPE_TEXT_INPUT, CUSTOM_LAYOUT_ELEMENT_TYPE_TEXT_EDITOR, CUSTOM_LAYOUT_ELEMENT_TYPE_CANVAS, CUSTOM_LAYOUT_ELEMENT_TYPE_DYNAMIC_TEXTURE, CUSTOM_LAYOUT_ELEMENT_TYPE_SPARKLINE, CUSTOM_LAYOUT_ELEMENT_TYPE_FLAME_GRAPH } CustomLayoutElementType;
 
 typedef struct {
   Model model;
@@ -59,10 +144,82 @@ typedef struct {
   Matrix rotation;
 } CustomLayoutElement_3DModel;
 
+typedef struct {
+  int32_t start; // Byte offset into the text
+  int32_t length;
+  Clay_Color color;
+  uint16_t fontId;
+  uint16_t fontSize;
+} TextSpan;
+
+// One line of text drawn as a run per span, bottom aligned to `height`. Spans start at `offsets`, or for monospace
+// text with no offsets character `i` is placed at `i * advance`
+typedef struct {
+  const char *chars;
+  int32_t length;
+  TextSpan *spans;
+  int32_t spanCount;
+  float *offsets;
+  float advance;
+  float height;
+} CustomLayoutElement_TextSpans;
+
+typedef struct {
+  Clay_String *lines;
+  int32_t lineCount;
+  Clay_Color color;
+  uint16_t fontId;
+  uint16_t fontSize;
+  float lineHeight;
+} CustomLayoutElement_PreText;
+
+// Samples are read straight from the caller's slice at render time. Queued by the renderer and drawn together with
+// the other queued sparklines, `box` and `next` are filled in then
+typedef struct CustomLayoutElement_Sparkline {
+  const float *values;
+  int32_t count;
+  float min;
+  float max;
+  Clay_Color color;
+  Clay_BoundingBox box;
+  struct CustomLayoutElement_Sparkline *next;
+} CustomLayoutElement_Sparkline;
+
+typedef struct {
+  float x;
+  float y;
+  Clay_String text;
+} FlameLabel;
+
+// Blocks relative to the element, then the labels that fit in theirs
+typedef struct {
+  struct CanvasBatch *blocks;
+  FlameLabel *labels;
+  int32_t labelCount;
+  Clay_Color textColor;
+  uint16_t fontId;
+  uint16_t fontSize;
+} CustomLayoutElement_FlameGraph;
+
+typedef struct GlyphGridState GlyphGridState;
+typedef struct TextInputState TextInputState;
+typedef struct TextEditorState TextEditorState;
+typedef struct CanvasBatch CanvasBatch;
+typedef struct DynamicTexture DynamicTexture;
+
 typedef struct {
   CustomLayoutElementType type;
   union {
     CustomLayoutElement_3DModel model;
+    CustomLayoutElement_TextSpans textSpans;
+    GlyphGridState *glyphGrid;
+    CustomLayoutElement_PreText preText;
+    CustomLayoutElement_Sparkline sparkline;
+    CustomLayoutElement_FlameGraph flameGraph;
+    TextInputState *textInput;
+    TextEditorState *textEditor;
+    CanvasBatch *canvas;
+    DynamicTexture *dynamicTexture;
   } customData;
 } CustomLayoutElement;
 
@@ -90,25 +247,123 @@ void ArenaReset(Arena *arena);
 // This makes sure right alignment on 86/64 bits
 #define DEFAULT_ALIGNMENT (2 * sizeof(void *))
 
+/* HDR style histogram, inspired from:
+   https://github.com/HdrHistogram/HdrHistogram_c
+   Values are microseconds. With HISTOGRAM_SUB_BUCKET_BITS = 6 there are 64 sub buckets, the values below 64 get one
+   each and every power of two above that is split linearly across the upper 32 (its half of the 64), so any
+   percentile is within ~3% of the real value from 1us up to an hour, in a fixed 3.7KB with no allocations.
+*/
+#define HISTOGRAM_SUB_BUCKET_BITS 6
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_HALF_SUB_BUCKETS (HISTOGRAM_SUB_BUCKETS / 2)
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_BUCKETS + (32 - HISTOGRAM_SUB_BUCKET_BITS) * HISTOGRAM_HALF_SUB_BUCKETS)
+
+typedef struct {
+  uint32_t counts[HISTOGRAM_BUCKETS];
+  uint64_t total;
+  uint32_t max;
+} Histogram;
+
+void HistogramRecord(Histogram *histogram, uint32_t value);
+uint32_t HistogramPercentile(Histogram *histogram, double percentile);
+void HistogramReset(Histogram *histogram);
+
 /* Our renderer.h specifics */
+typedef enum {
+  RENDER_PHASE_FRAME,  // Whole loop iteration, input polling through the draw callback and the vsync wait of its `EndDrawing`
+  RENDER_PHASE_UPDATE, // Update callback
+  RENDER_PHASE_DRAW,   // Draw callback
+  RENDER_PHASE_LAYOUT, // `BeginLayout` to `EndLayout`
+  RENDER_PHASE_RENDER, // `Clay_Raylib_Render`
+  RENDER_PHASE_COUNT,
+} RenderPhase;
+
+// Per frame counters, kept where `Clay_Raylib_Render` draws and flushes so raylib calls made directly in the draw
+// callback, the HUDs included, aren't in them
+typedef struct {
+  uint32_t drawCalls;      // GPU draw calls issued by batch flushes
+  uint32_t vertices;       // Vertices submitted to the batch
+  uint32_t textureBinds;   // Texture changes that split the batch into another draw call
+  uint32_t scissorChanges; // Scissor starts and ends, each one flushes the batch
+  uint32_t batchFlushes;   // Times the batch was uploaded and drawn
+} RenderCounters;
+
+// Times in milliseconds
+typedef struct {
+  uint64_t count;
+  double p50;
+  double p90;
+  double p99;
+  double max;
+} FrameStats;
+
 typedef struct {
   int32_t totalMemorySize;
   Clay_Arena clayMemory;
   Font fonts[4];
+  Arena frameArena; // Reset on `BeginLayout`, for anything the frame's render commands point to
   bool reinitialize;
   bool debugEnabled;
   bool shouldClose;
+  uint64_t frameIndex;
+
+  // Frame stats
+  Histogram phases[RENDER_PHASE_COUNT];
+  double layoutStart;
+  char *statsPath;
+  float statsInterval;
+  double lastStatsExport;
+
+  // Render counters
+  RenderCounters counters;
+  RenderCounters frameCounters;
 } Renderer;
 extern Renderer renderer;
 
+FrameStats GetFrameStats(RenderPhase phase);
+void ResetFrameStats(void);
+// Writes every phase's percentiles to `path`, as JSON if it ends in `.json` and CSV otherwise
+bool ExportFrameStats(const char *path);
+
+// Counters of the last complete frame
+RenderCounters GetRenderCounters(void);
+// Draws the last frame's counters, call it between `BeginDrawing` and `EndDrawing`
+void DrawRenderCountersHud(int32_t x, int32_t y);
+
 void HandleClayErrors(Clay_ErrorData errorData);
 static void initDraw();
 
+// Wrappers around `Clay_BeginLayout` and `Clay_EndLayout` so the renderer can trace the layout phase
+void BeginLayout(void);
+Clay_RenderCommandArray EndLayout(void);
+
 void ScrollContainerByY(char *containerName, float deltaY);
 void ScrollContainerTop(char *containerName);
 void ScrollContainerBottom(char *containerName);
 void ScrollContainerByX(char *containerName, float deltaX);
 
+// Scroll container resolved by id, the name is hashed once and the container is looked up at most once per frame
+typedef struct {
+  Clay_ElementId id;
+  uint64_t resolvedFrame; // `renderer.frameIndex + 1` of the last lookup, 0 if never resolved
+  Clay_ScrollContainerData data;
+} ScrollHandle;
+
+typedef struct {
+  ScrollHandle *handle;
+  float deltaX;
+  float deltaY;
+} ScrollUpdate;
+
+ScrollHandle ScrollHandleGet(char *containerName);
+// Returns false if the container wasn't part of the last layout
+bool ScrollHandleResolve(ScrollHandle *handle);
+void ScrollHandleByY(ScrollHandle *handle, float deltaY);
+void ScrollHandleByX(ScrollHandle *handle, float deltaX);
+void ScrollHandleTop(ScrollHandle *handle);
+void ScrollHandleBottom(ScrollHandle *handle);
+void ScrollContainersBy(ScrollUpdate *updates, int32_t count);
+
 Clay_String s(const char *msg);
 
 typedef struct {
@@ -116,6 +371,24 @@ typedef struct {
   int32_t width;
   char *windowName;
   char *fontPath;
+
+  // Only used with `RENDERER_ALLOC_CHECK`
+  int32_t allocWarmupFrames; // Frames allowed to allocate before checking starts, defaults to 60
+  bool allocAbort;           // Abort on the first frame that allocates instead of just reporting it
+
+  // Frame stats, written on exit and every `statsInterval` seconds if it's not 0
+  char *statsPath;
+  float statsInterval;
+
+  // Render batch size, 0 keeps raylib's defaults. Bigger buffers mean fewer flushes when the batch fills up
+  int32_t batchElements; // Quads per buffer
+  int32_t batchBuffers;
+
+  // Input recording, only one of them can be set
+  char *inputRecordPath; // Writes every frame's input to this file, live input is used if it can't be opened
+  char *inputReplayPath; // Reads input from this file instead of raylib, the window closes when it runs out
+
+  size_t frameArenaSize; // Defaults to 4MB
 } RenderOptions;
 
 typedef void (*Callback)(void);
@@ -129,6 +402,52 @@ enum {
 
 void RenderSetup(RenderOptions options, Callback updateCallback, Callback drawCallback);
 
+/* Input recording and replay. Every frame's pointer, wheel, key and character events, window size and frame time are
+   captured once at the start of the frame, recorded to `inputRecordPath` or read back from `inputReplayPath`. Use these
+   instead of the raylib functions in update and draw so a replayed session runs exactly like the recorded one. The
+   file is a magic and a format version, then each frame field by field in little endian, so it replays on any machine.
+   Key or char events past `INPUT_MAX_EVENTS` in one frame are dropped with a warning.
+*/
+#define INPUT_MAX_KEYS 349 // KEY_KB_MENU + 1
+#define INPUT_MAX_EVENTS 64
+
+typedef enum {
+  INPUT_LIVE,
+  INPUT_RECORD,
+  INPUT_REPLAY,
+} InputMode;
+
+typedef struct {
+  float mouseX;
+  float mouseY;
+  float wheelX;
+  float wheelY;
+  float frameTime;
+  uint16_t width;
+  uint16_t height;
+  uint8_t mouseButtons; // Bit per button held
+  uint8_t keyCount;
+  uint8_t charCount;
+  uint16_t keys[INPUT_MAX_EVENTS]; // Key code, with the flags below
+  uint32_t chars[INPUT_MAX_EVENTS];
+} InputFrame;
+
+#define INPUT_KEY_REPEAT 0x4000
+#define INPUT_KEY_RELEASED 0x8000
+
+Vector2 InputMousePosition(void);
+bool InputMouseButtonDown(int button);
+bool InputMouseButtonPressed(int button);
+Vector2 InputMouseWheel(void);
+bool InputKeyDown(int key);
+bool InputKeyPressed(int key);
+bool InputKeyPressedRepeat(int key);
+bool InputKeyReleased(int key);
+int InputCharPressed(void);
+float InputFrameTime(void);
+int InputScreenWidth(void);
+int InputScreenHeight(void);
+
 #ifdef __clang__
 /*  Printf like warnings on format */
 #define FORMAT_CHECK(fmt_pos, args_pos) __attribute__((format(printf, fmt_pos, args_pos)))
@@ -138,6 +457,101 @@ void RenderSetup(RenderOptions options, Callback updateCallback, Callback drawCa
 
 Clay_String F(Arena *arena, const char *format, ...) FORMAT_CHECK(2, 3);
 
+/* Threads, just enough of pthreads and Win32 for the renderer's background work */
+#ifdef _WIN32
+typedef HANDLE RenderThread;
+typedef CRITICAL_SECTION RenderMutex;
+typedef CONDITION_VARIABLE RenderCondition;
+#else
+typedef pthread_t RenderThread;
+typedef pthread_mutex_t RenderMutex;
+typedef pthread_cond_t RenderCondition;
+#endif
+
+typedef void (*RenderThreadFunction)(void *arg);
+bool RenderThreadStart(RenderThread *thread, RenderThreadFunction function, void *arg);
+void RenderThreadJoin(RenderThread thread);
+void RenderSleep(double seconds);
+int32_t RenderCoreCount(void);
+
+// Runs `function` for tasks `0..taskCount - 1` across a pool with a worker per core, the calling thread included, and
+// returns once they're all done. Only call it from one thread at a time
+typedef void (*RenderTaskFunction)(int32_t task, void *arg);
+void RenderParallelFor(int32_t taskCount, RenderTaskFunction function, void *arg);
+
+/* Logging. Messages are formatted on the calling thread into a lock-free ring buffer and written out by a background
+   thread, so logging never blocks a frame on terminal I/O. Levels below `RENDERER_LOG_LEVEL` compile out, and every
+   call site is limited to `RENDERER_LOG_BURST` messages a second, ex:
+     LogWarn(LOG_CATEGORY_APP, "Couldn't load %s", path);
+*/
+#define RENDER_LOG_DEBUG 0
+#define RENDER_LOG_INFO 1
+#define RENDER_LOG_WARN 2
+#define RENDER_LOG_ERROR 3
+#define RENDER_LOG_NONE 4
+
+#ifndef RENDERER_LOG_LEVEL
+#define RENDERER_LOG_LEVEL RENDER_LOG_INFO
+#endif
+
+#ifndef RENDERER_LOG_BURST
+#define RENDERER_LOG_BURST 5
+#endif
+
+#define LOG_RING_SIZE 256 // Power of two
+#define LOG_MESSAGE_SIZE 240
+
+typedef enum {
+  LOG_CATEGORY_RENDERER,
+  LOG_CATEGORY_CLAY,
+  LOG_CATEGORY_SCROLL,
+  LOG_CATEGORY_INPUT,
+  LOG_CATEGORY_APP,
+  LOG_CATEGORY_COUNT,
+} LogCategory;
+
+// Rate limiting state, one per call site and shared by every thread logging from it
+typedef struct {
+  atomic_uint_least64_t window; // Second of `GetTime()` the count is for
+  atomic_uint count;
+  atomic_uint suppressed;
+} LogSite;
+
+void LogWrite(LogSite *site, int level, LogCategory category, const char *format, ...) FORMAT_CHECK(4, 5);
+void LogSetCategoryEnabled(LogCategory category, bool enabled);
+// Blocks until everything queued so far is written
+void LogFlush(void);
+
+#define RENDER_LOG(level, category, ...)                                                                                                                                                                                                       \
+  do {                                                                                                                                                                                                                                         \
+    static LogSite logSite = {0};                                                                                                                                                                                                              \
+    LogWrite(&logSite, level, category, __VA_ARGS__);                                                                                                                                                                                          \
+  } while (0)
+
+#if RENDERER_LOG_LEVEL <= RENDER_LOG_DEBUG
+#define LogDebug(category, ...) RENDER_LOG(RENDER_LOG_DEBUG, category, __VA_ARGS__)
+#else
+#define LogDebug(category, ...) ((void)0)
+#endif
+
+#if RENDERER_LOG_LEVEL <= RENDER_LOG_INFO
+#define LogInfo(category, ...) RENDER_LOG(RENDER_LOG_INFO, category, __VA_ARGS__)
+#else
+#define LogInfo(category, ...) ((void)0)
+#endif
+
+#if RENDERER_LOG_LEVEL <= RENDER_LOG_WARN
+#define LogWarn(category, ...) RENDER_LOG(RENDER_LOG_WARN, category, __VA_ARGS__)
+#else
+#define LogWarn(category, ...) ((void)0)
+#endif
+
+#if RENDERER_LOG_LEVEL <= RENDER_LOG_ERROR
+#define LogError(category, ...) RENDER_LOG(RENDER_LOG_ERROR, category, __VA_ARGS__)
+#else
+#define LogError(category, ...) ((void)0)
+#endif
+
 typedef struct {
   Clay_Color color;
   char width[6];
@@ -175,28 +589,754 @@ typedef struct {
 
 static Clay_ElementDeclaration ParseComponentOptions(ComponentOptions options, Clay_ElementDeclaration defaultOptions);
 
+/* Per element cost attribution, compiled in with `RENDERER_ATTRIBUTION`. Every element, text and render command is
+   tagged with the `ComponentOptions.id` of its nearest named ancestor, and the costs below are accumulated per id.
+*/
+#ifdef RENDERER_ATTRIBUTION
+#define ATTRIBUTION_MAX_ENTRIES 256
+#define ATTRIBUTION_MAX_DEPTH 128
+
+typedef struct {
+  const char *id; // Copy owned by the table, NULL for elements without a named ancestor
+  uint32_t hash;
+  uint64_t elements;  // Elements declared
+  uint64_t commands;  // Render commands translated
+  uint64_t drawCalls; // Raylib draw calls issued
+  uint64_t vertices;  // Vertices submitted
+  uint64_t textBytes; // Bytes of text measured on Clay cache misses
+  double renderTime;  // Seconds spent translating render commands
+} AttributionEntry;
+
+void AttributionPush(const char *id);
+void AttributionPop(void);
+Clay_TextElementConfig *AttributionTextConfig(Clay_TextElementConfig *textConfig);
+
+// Fills `entries` with up to `count` ids sorted by render time, returns how many were written
+int32_t GetAttributionTop(AttributionEntry *entries, int32_t count);
+void ResetAttribution(void);
+// Writes every id as CSV, with costs averaged per frame since the last reset
+bool ExportAttribution(const char *path);
+// Draws the top `count` offenders, call it between `BeginDrawing` and `EndDrawing`
+void DrawAttributionHud(int32_t x, int32_t y, int32_t count);
+#endif
+
 // Better MACROS
+#ifdef RENDERER_ATTRIBUTION
+#define TextS(text, textConfig) Clay__OpenTextElement(CLAY_STRING(text), AttributionTextConfig(textConfig))
+#define Text(text, textConfig) Clay__OpenTextElement(text, AttributionTextConfig(textConfig))
+#else
 #define TextS(text, textConfig) Clay__OpenTextElement(CLAY_STRING(text), textConfig)
 #define Text(text, textConfig) Clay__OpenTextElement(text, textConfig)
+#endif
 
 #define COMPONENT_OPTIONS(...) ((ComponentOptions){__VA_ARGS__})
 
+#ifdef RENDERER_ATTRIBUTION
+#define COMPONENT_CONCAT_(a, b) a##b
+#define COMPONENT_CONCAT(a, b) COMPONENT_CONCAT_(a, b)
+#define COMPONENT_OPTIONS_NAME COMPONENT_CONCAT(componentOptions, __LINE__)
+#define COMPONENT_LATCH_NAME COMPONENT_CONCAT(componentLatch, __LINE__)
+// Same latch trick as `CLAY`, the options are evaluated once and the attribution scope is popped once the element
+// closes. The names carry the line so a nested component on another line doesn't shadow its parent's
+#define COMPONENT(defaultOptions, ...)                                                                                                                                                                \
+  for (ComponentOptions COMPONENT_OPTIONS_NAME = COMPONENT_OPTIONS(__VA_ARGS__), *COMPONENT_LATCH_NAME = (AttributionPush(COMPONENT_OPTIONS_NAME.id), &COMPONENT_OPTIONS_NAME); COMPONENT_LATCH_NAME; \
+       COMPONENT_LATCH_NAME = NULL, AttributionPop())                                                                                                                                                 \
+  CLAY(ParseComponentOptions(COMPONENT_OPTIONS_NAME, defaultOptions))
+#else
+#define COMPONENT(defaultOptions, ...) CLAY(ParseComponentOptions(COMPONENT_OPTIONS(__VA_ARGS__), defaultOptions))
+#endif
+
 static Clay_ElementDeclaration boxDefaultOptions = {.layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM, .sizing = {.width = CLAY_SIZING_FIT(0), .height = CLAY_SIZING_FIT(0)}}};
-#define Box(...) CLAY(ParseComponentOptions(COMPONENT_OPTIONS(__VA_ARGS__), boxDefaultOptions))
+#define Box(...) COMPONENT(boxDefaultOptions, __VA_ARGS__)
 
 // Column - A vertical layout container (top to bottom)
 static Clay_ElementDeclaration columnDefaultOptions = {.layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM, .sizing = {.width = CLAY_SIZING_FIT(0), .height = CLAY_SIZING_FIT(0)}}};
-#define Column(...) CLAY(ParseComponentOptions(COMPONENT_OPTIONS(__VA_ARGS__), columnDefaultOptions))
+#define Column(...) COMPONENT(columnDefaultOptions, __VA_ARGS__)
 
 // Row - A horizontal layout container (left to right)
 static Clay_ElementDeclaration rowDefaultOptions = {.layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT, .sizing = {.width = CLAY_SIZING_FIT(0), .height = CLAY_SIZING_FIT(0)}}};
-#define Row(...) CLAY(ParseComponentOptions(COMPONENT_OPTIONS(__VA_ARGS__), rowDefaultOptions))
+#define Row(...) COMPONENT(rowDefaultOptions, __VA_ARGS__)
 
 static Clay_ElementDeclaration separatorDefaultOptions = {.layout = {.sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0)}}};
-#define Separator(...) CLAY(ParseComponentOptions(COMPONENT_OPTIONS(__VA_ARGS__), separatorDefaultOptions))
+#define Separator(...) COMPONENT(separatorDefaultOptions, __VA_ARGS__)
 
 static Clay_ElementDeclaration marginDefaultOptions = {.layout = {.sizing = {.width = CLAY_SIZING_FIT(0), .height = CLAY_SIZING_FIT(0)}}};
-#define Margin(...) CLAY(ParseComponentOptions(COMPONENT_OPTIONS(__VA_ARGS__), separatorDefaultOptions))
+#define Margin(...) COMPONENT(separatorDefaultOptions, __VA_ARGS__)
+
+/* VirtualList - A vertical scroll container that only declares the rows intersecting its viewport plus `overscan`, with
+   spacers standing in for the rest, so its cost doesn't depend on `rowCount`. `onRow` declares a single row, which
+   should be `rowHeight` tall, ex:
+     VirtualList(.id = "Log", .w = "grow-0", .h = "grow-0", .rowCount = lineCount, .rowHeight = 20, .onRow = drawLine);
+*/
+typedef void (*VirtualRowCallback)(int32_t row, void *userData);
+
+typedef struct {
+  char *id; // Required, the scroll position is looked up by it
+  char *w;
+  char *h;
+  Clay_Color bg;
+
+  int32_t rowCount;
+  float rowHeight;  // Fixed height, or an estimate when rows size themselves
+  int32_t overscan; // Rows declared past each edge of the viewport, defaults to 4
+  VirtualRowCallback onRow;
+  void *userData;
+} VirtualListOptions;
+
+void VirtualListDeclare(VirtualListOptions options);
+#define VirtualList(...) VirtualListDeclare((VirtualListOptions){__VA_ARGS__})
+
+/* VirtualGrid - A table virtualized on both axes with sticky header row and leading columns. Only visible cells are
+   declared, `onCell` fills one fixed size cell and gets `VIRTUAL_GRID_HEADER` as the row for header cells. Column
+   widths come from `columnWidths`, or `measureColumn` called once per column, and are cached in `state` with their
+   prefix sums, call `VirtualGridInvalidate` when they change and `VirtualGridFree` once the grid is gone. Offsets are
+   kept in doubles, but Clay lays out and scrolls in floats, so past 2^24 px (~800k rows of 20 px) rows and columns
+   can land a pixel off.
+*/
+#define VIRTUAL_GRID_HEADER -1
+
+typedef void (*VirtualCellCallback)(int32_t row, int32_t column, void *userData);
+typedef float (*VirtualColumnWidthCallback)(int32_t column, void *userData);
+
+typedef struct {
+  double *columnOffsets; // `columnCount + 1` prefix sums of the column widths
+  int32_t columnCount;
+  Clay_Vector2 lastScroll; // Body scroll position we last synced the sticky panes to
+} VirtualGridState;
+
+typedef struct {
+  char *id; // Required, scroll positions are looked up by it
+  char *w;
+  char *h;
+  Clay_Color bg;
+  Clay_Color headerBg;
+
+  int32_t rowCount;
+  int32_t columnCount;
+  float rowHeight;
+  float headerHeight;    // 0 for no header row
+  int32_t stickyColumns; // Leading columns that don't scroll horizontally
+  float *columnWidths;   // Explicit widths, NULL to measure with `measureColumn`
+  VirtualColumnWidthCallback measureColumn;
+  int32_t overscan; // Rows and columns declared past each edge of the viewport, defaults to 2
+  VirtualCellCallback onCell;
+  void *userData;
+  VirtualGridState *state; // Required
+} VirtualGridOptions;
+
+void VirtualGridDeclare(VirtualGridOptions options);
+void VirtualGridInvalidate(VirtualGridState *state);
+void VirtualGridFree(VirtualGridState *state);
+#define VirtualGrid(...) VirtualGridDeclare((VirtualGridOptions){__VA_ARGS__})
+
+/* VirtualTree - A tree kept as a flat array of its visible nodes, each with its depth, its parent's row and the number
+   of visible descendants that follow it. Expanding inserts a node's children right after it and collapsing removes its
+   subtree in one move, so both cost the nodes touched instead of a rebuild, and the array renders through
+   `VirtualList`. Nodes are unique ids given by `childCount` and `child`, `root` itself isn't shown. Which nodes are
+   expanded is kept per id, so expanding a node again brings back the descendants that were open when it collapsed.
+*/
+typedef int32_t (*VirtualTreeChildCountCallback)(uint32_t node, void *userData);
+typedef uint32_t (*VirtualTreeChildCallback)(uint32_t node, int32_t index, void *userData);
+
+typedef struct {
+  uint32_t node;
+  uint32_t subtreeSize; // Visible descendants, they're the entries right after this one
+  int32_t parent;       // Row of the parent, -1 at the top level
+  uint16_t depth;
+  bool expanded;
+  bool hasChildren;     // Asked for when the row is first shown, valid with `childrenCounted`
+  bool childrenCounted;
+} VirtualTreeNode;
+
+typedef struct {
+  VirtualTreeNode *nodes;
+  int32_t count;
+  int32_t capacity;
+  uint32_t *expandedNodes; // Sorted ids, including the ones under a collapsed ancestor
+  int32_t expandedCount;
+  int32_t expandedCapacity;
+  VirtualTreeNode *scratch; // Rows being put together by an expand
+  int32_t scratchCount;
+  int32_t scratchCapacity;
+  VirtualTreeChildCountCallback childCount;
+  VirtualTreeChildCallback child;
+  void *userData;
+} VirtualTreeState;
+
+typedef void (*VirtualTreeRowCallback)(VirtualTreeNode *node, int32_t row, void *userData);
+
+typedef struct {
+  char *id; // Required, the scroll position is looked up by it
+  char *w;
+  char *h;
+  Clay_Color bg;
+
+  float rowHeight;
+  int32_t overscan;
+  VirtualTreeState *state; // Required
+  VirtualTreeRowCallback onRow;
+  void *userData;
+} VirtualTreeOptions;
+
+VirtualTreeState VirtualTreeInit(uint32_t root, VirtualTreeChildCountCallback childCount, VirtualTreeChildCallback child, void *userData);
+void VirtualTreeFree(VirtualTreeState *state);
+void VirtualTreeExpand(VirtualTreeState *state, int32_t row);
+void VirtualTreeCollapse(VirtualTreeState *state, int32_t row);
+void VirtualTreeToggle(VirtualTreeState *state, int32_t row);
+void VirtualTreeDeclare(VirtualTreeOptions options);
+#define VirtualTree(...) VirtualTreeDeclare((VirtualTreeOptions){__VA_ARGS__})
+
+/* FileView - A memory mapped file shown one line per row, for tailing logs of any size. A background thread builds the
+   line index by reading the file in blocks, into chunks that never move so rows can be read while it appends, and in
+   tail mode keeps polling for appended data. Visible lines are `Clay_String` slices straight into the mapping, so
+   memory use is the index, 8 bytes a line, whatever the file size. A file that shrinks, like a log rotated with
+   copytruncate, is remapped and indexed again from the start.
+*/
+#define FILE_VIEW_CHUNK_LINES 65536
+#define FILE_VIEW_MAX_CHUNKS 32768 // ~2G lines, VirtualList's row limit
+
+typedef struct {
+  // Mapping, only touched by the render thread
+  const char *data;
+  size_t mappedSize;
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE mapping;
+#else
+  int fd;
+#endif
+  uint64_t fileSize; // As of the last `FileViewDeclare`, slices never go past it
+  double lastSizeCheck;
+  bool indexing; // The indexer was started and not joined yet
+  bool tail;
+  bool following; // Scrolled to the bottom, keep it there as lines come in
+  float followedPosition;
+
+  // Line index, written by the indexer. `lineStarts` entries before `lineStartCount` never change again
+  uint64_t *lineStarts[FILE_VIEW_MAX_CHUNKS];
+  atomic_size_t lineStartCount;
+  atomic_uint_least64_t indexedSize;
+  atomic_bool running;
+  atomic_bool shrunk;    // The indexer saw the file get smaller than what it indexed and stopped
+  atomic_bool truncated; // Past `FILE_VIEW_MAX_CHUNKS` lines, the rest of the file isn't indexed
+  RenderThread indexer;
+} FileViewState;
+
+typedef struct {
+  char *id; // Required, the scroll position is looked up by it
+  char *w;
+  char *h;
+  Clay_Color bg;
+
+  float rowHeight;
+  int32_t maxLineLength; // Longer lines are cut when shown, defaults to 2048
+  Clay_TextElementConfig *textConfig;
+  FileViewState *state; // Required
+} FileViewOptions;
+
+// Returns NULL if the file can't be opened or its indexer can't start, with `tail` the index keeps following appends
+FileViewState *FileViewOpen(const char *path, bool tail);
+void FileViewClose(FileViewState *state);
+int32_t FileViewLineCount(FileViewState *state);
+// Slice into the mapping without the line break, empty if the line isn't mapped yet
+Clay_String FileViewLine(FileViewState *state, int32_t line);
+void FileViewDeclare(FileViewOptions options);
+#define FileView(...) FileViewDeclare((FileViewOptions){__VA_ARGS__})
+
+/* HexView - A memory dump with an address column, `bytesPerRow` hex bytes and their ASCII, colored by byte class.
+   Rows are encoded with a lookup table into the frame arena and each one is a single custom element drawing a run
+   per color span, instead of a text element per byte.
+*/
+typedef struct {
+  char *id; // Required, the scroll position is looked up by it
+  char *w;
+  char *h;
+  Clay_Color bg;
+
+  const uint8_t *data;
+  size_t size;
+  uint64_t baseAddress;
+  int32_t bytesPerRow; // Defaults to 16
+  float rowHeight;     // Defaults to `fontSize + 4`
+  uint16_t fontId;     // Should be a monospace font
+  uint16_t fontSize;
+
+  // Colors, each defaults to a shade of white
+  Clay_Color addressColor;
+  Clay_Color zeroColor;
+  Clay_Color printableColor;
+  Clay_Color controlColor;
+  Clay_Color highColor;
+} HexViewOptions;
+
+void HexViewDeclare(HexViewOptions options);
+#define HexView(...) HexViewDeclare((HexViewOptions){__VA_ARGS__})
+
+/* RichText - A single line with its own color and font per span, for things like syntax highlighted code. Spans are in
+   order and all measured in one pass, so the line is one element and one render command however many tokens it has.
+   Text between spans is skipped over. The text and spans are copied, so they only need to outlive the call, ex:
+     TextSpan spans[] = {{.start = 0, .length = 6, .color = KEYWORD, .fontId = FONT_18, .fontSize = 18}, ...};
+     RichText(line, spans, 3);
+*/
+void RichTextDeclare(Clay_String text, TextSpan *spans, int32_t spanCount);
+#define RichText(text, spans, spanCount) RichTextDeclare(text, spans, spanCount)
+
+/* PreText - A block of preformatted lines that never wrap, like disassembly or stack traces. Its size is the line count
+   times `lineHeight` by the widest line, measured in one pass without going through Clay's word cache and then cached
+   per `lines` array, and only the lines inside the current scissor are drawn. `lines` has to stay alive until the frame
+   is rendered.
+*/
+typedef struct {
+  Clay_String *lines;
+  int32_t lineCount;
+  Clay_Color color;
+  uint16_t fontId;
+  uint16_t fontSize;
+  float lineHeight; // Defaults to `fontSize`
+  float width;      // Widest line if already known, 0 measures the lines once per array, pass a new one when the text changes
+} PreTextOptions;
+
+float PreTextMeasure(Clay_String *lines, int32_t lineCount, uint16_t fontId, uint16_t fontSize);
+void PreTextDeclare(PreTextOptions options);
+#define PreText(...) PreTextDeclare((PreTextOptions){__VA_ARGS__})
+
+/* TextInput - A single line text field. The text lives in a gap buffer so edits only move the bytes between the last
+   edit and this one, and the x of every byte is cached as prefix advances that are recomputed lazily from the first
+   edited byte, only as far as the caret and the visible part of the field. Text is single byte characters, like
+   `Raylib_MeasureText` assumes.
+*/
+struct TextInputState {
+  // Gap buffer, the text is `buffer[0, gapStart)` followed by `buffer[gapEnd, capacity)`
+  char *buffer;
+  int32_t capacity;
+  int32_t gapStart;
+  int32_t gapEnd;
+
+  // Selection is between `anchor` and `caret`, empty when they're equal
+  int32_t caret;
+  int32_t anchor;
+  bool focused;
+  bool selecting; // Dragging with the mouse
+  float scrollX;
+  float viewWidth; // Width of the text area in the last rendered frame
+
+  // `advances[i]` is the x of byte `i`, valid up to and including `advancesValid`
+  float *advances;
+  int32_t advancesCapacity;
+  int32_t advancesValid;
+  uint16_t fontId;
+  uint16_t fontSize;
+
+  Clay_Color textColor;
+  Clay_Color selectionColor;
+};
+
+typedef struct {
+  char *id; // Required, used to focus the field on click
+  char *w;
+  Clay_Color bg;
+  TextInputState *state; // Required
+} TextInputOptions;
+
+void TextInputInit(TextInputState *state, uint16_t fontId, uint16_t fontSize);
+void TextInputFree(TextInputState *state);
+int32_t TextInputLength(TextInputState *state);
+// Contiguous copy of the text in the frame arena, valid until the next `BeginLayout`
+Clay_String TextInputText(TextInputState *state);
+void TextInputSetText(TextInputState *state, Clay_String text);
+void TextInputDeclare(TextInputOptions options);
+#define TextInput(...) TextInputDeclare((TextInputOptions){__VA_ARGS__})
+
+/* TextEditor - A multi line editor for large buffers. The text is a piece table over the original text and an append
+   only buffer of everything typed, so an edit never moves the document. The pieces are a gap buffer kept at the last
+   edit with a Fenwick tree over their lengths, so finding the piece at an offset is O(log n). The line index is a gap
+   buffer kept at the last edited line, with the lines after the gap stored relative to the end of the text so an edit
+   never shifts them, and every line's wrapped row count is kept in a Fenwick tree over its slots so finding the line
+   at a scroll position is O(log n). Each line keeps its wrap breaks, an edit within a line only re-wraps from two rows
+   before it until the breaks line up with the old ones again, and only the rows in view are copied out to be drawn.
+   When the width changes lines are only re-wrapped once they're scrolled into view.
+*/
+typedef struct {
+  bool added; // In `added` instead of `original`
+  int32_t start;
+  int32_t length;
+} TextPiece;
+
+struct TextEditorState {
+  // Piece table, one slot per piece with a gap at `[pieceGapStart, pieceGapEnd)`. `pieceTree` is the 1 based Fenwick
+  // tree over the piece lengths, where gap slots have length 0
+  char *original;
+  char *added;
+  int32_t addedLength;
+  int32_t addedCapacity;
+  TextPiece *pieces;
+  int32_t *pieceTree;
+  int32_t pieceCount;
+  int32_t pieceCapacity;
+  int32_t pieceGapStart;
+  int32_t pieceGapEnd;
+  int32_t length;
+
+  // Line index and wrap cache, one slot per line with a gap at `[lineGapStart, lineGapEnd)`. Starts before the gap
+  // are offsets, after it distances from the end of the text. `rowTree` is the 1 based Fenwick tree over `lineRows`,
+  // where gap slots have 0 rows
+  int32_t *lineStarts;
+  int32_t *lineRows;
+  int32_t **lineBreaks;  // Offsets in the line the rows after the first start at, NULL for a single row
+  uint32_t *lineWrapped; // `wrapGeneration` the line was wrapped in
+  int32_t *rowTree;
+  int32_t lineCount;
+  int32_t lineCapacity;
+  int32_t lineGapStart;
+  int32_t lineGapEnd;
+  uint32_t wrapGeneration;
+  float wrapWidth;
+
+  int32_t caret;
+  bool focused;
+  bool caretMoved; // Scroll the caret into view on the next declare
+  float viewWidth; // Width of the text in the last rendered frame
+  char *scratch;   // Text copied out of the pieces
+  int32_t scratchCapacity;
+
+  uint16_t fontId;
+  uint16_t fontSize;
+  float lineHeight;
+  float charWidths[128];
+  Clay_Color textColor;
+};
+
+typedef struct {
+  char *id; // Required, the scroll position is looked up by it
+  char *w;
+  char *h;
+  Clay_Color bg;
+  TextEditorState *state; // Required
+} TextEditorOptions;
+
+void TextEditorInit(TextEditorState *state, Clay_String text, uint16_t fontId, uint16_t fontSize);
+void TextEditorFree(TextEditorState *state);
+// Replaces `deleteLength` bytes at `offset` with `chars`
+void TextEditorReplace(TextEditorState *state, int32_t offset, int32_t deleteLength, const char *chars, int32_t insertLength);
+void TextEditorCopy(TextEditorState *state, int32_t offset, int32_t length, char *destination);
+void TextEditorDeclare(TextEditorOptions options);
+#define TextEditor(...) TextEditorDeclare((TextEditorOptions){__VA_ARGS__})
+
+/* Canvas - An element drawing a batch of user geometry in one call, clipped to its box. Batches come from the frame
+   arena with a fixed capacity, coordinates are relative to the canvas' top left and `CanvasSize` gives the size it
+   had in the last layout to scale to, ex:
+     Vector2 size = CanvasSize("Plot");
+     CanvasBatch *batch = CanvasBatchAlloc(CANVAS_LINES, 2 * count, 0);
+     for (...) CanvasLine(batch, x0, y0, x1, y1, RED);
+     Canvas(.id = "Plot", .w = "grow-0", .h = "grow-0", .batch = batch);
+*/
+typedef enum {
+  CANVAS_LINES,     // Every 2 vertices are a line
+  CANVAS_TRIANGLES, // Every 3 vertices are a triangle
+  CANVAS_POINTS,    // Every vertex is a `pointSize` square
+} CanvasMode;
+
+typedef struct {
+  float x;
+  float y;
+  Color color;
+} CanvasVertex;
+
+struct CanvasBatch {
+  CanvasMode mode;
+  float pointSize;
+  CanvasVertex *vertices;
+  int32_t vertexCount;
+  int32_t vertexCapacity;
+  uint32_t *indices; // Optional, vertices are used in order without them
+  int32_t indexCount;
+  int32_t indexCapacity;
+};
+
+typedef struct {
+  char *id;
+  char *w;
+  char *h;
+  Clay_Color bg;
+  CanvasBatch *batch; // NULL draws nothing
+} CanvasOptions;
+
+CanvasBatch *CanvasBatchAlloc(CanvasMode mode, int32_t vertexCapacity, int32_t indexCapacity);
+// Returns the index of the first vertex added
+uint32_t CanvasVertices(CanvasBatch *batch, CanvasVertex *vertices, int32_t count);
+void CanvasIndices(CanvasBatch *batch, uint32_t *indices, int32_t count);
+void CanvasLine(CanvasBatch *batch, float x0, float y0, float x1, float y1, Color color);
+void CanvasTriangle(CanvasBatch *batch, Vector2 a, Vector2 b, Vector2 c, Color color);
+void CanvasPoint(CanvasBatch *batch, float x, float y, Color color);
+// Size in the last layout, 0 before the first one
+Vector2 CanvasSize(char *id);
+void CanvasDeclare(CanvasOptions options);
+#define Canvas(...) CanvasDeclare((CanvasOptions){__VA_ARGS__})
+
+/* SeriesStore - Keeps the last `capacity` samples of a live series in a ring, along with a pyramid of min/max/sum
+   buckets 8, 64, 512... samples wide that is updated as samples come in. Querying a range at pixel resolution then
+   takes the widest aligned buckets that fit in each column, O(width * log n) however many samples are in range.
+*/
+#define SERIES_FANOUT_BITS 3
+#define SERIES_MAX_LEVELS 16
+
+typedef struct {
+  float min;
+  float max;
+  double sum;
+} SeriesBucket;
+
+typedef struct {
+  float *samples;
+  int64_t capacity; // Power of two
+  int64_t count;    // Samples appended since init, sample `i` is kept while `i >= count - capacity`
+
+  // `levels[l]` holds buckets of `1 << (l * SERIES_FANOUT_BITS)` samples, level 0 is unused
+  SeriesBucket *levels[SERIES_MAX_LEVELS];
+  int32_t levelCount;
+} SeriesStore;
+
+// `capacity` is rounded up to a power of two
+void SeriesInit(SeriesStore *store, int64_t capacity);
+void SeriesFree(SeriesStore *store);
+void SeriesAppend(SeriesStore *store, float *values, int64_t count);
+// Oldest sample still kept
+int64_t SeriesFirst(SeriesStore *store);
+// Min, max and mean of each of `columns` equal slices of samples `[from, to)`, clamped to what's kept. `means` can be NULL
+void SeriesQuery(SeriesStore *store, int64_t from, int64_t to, int32_t columns, float *mins, float *maxs, float *means);
+
+/* LineChart - Plots evenly spaced samples decimated to the width of the chart, so the cost follows the panel width
+   instead of the sample count. `LINE_CHART_MIN_MAX` keeps each pixel column's envelope, which never hides a spike,
+   and `LINE_CHART_LTTB` (Largest Triangle Three Buckets) keeps the points that best preserve the shape. Either way the
+   result is one polyline drawn through `Canvas`.
+*/
+typedef enum {
+  LINE_CHART_MIN_MAX,
+  LINE_CHART_LTTB,
+} LineChartDecimation;
+
+typedef struct {
+  char *id; // Required, the chart is sized from its last layout
+  char *w;
+  char *h;
+  Clay_Color bg;
+
+  const float *values;
+  int64_t count;
+  // Or a live series, showing samples `[from, to)` with `to` 0 following the newest sample and `from` 0 everything kept.
+  // Always uses the min/max envelope
+  SeriesStore *series;
+  int64_t from;
+  int64_t to;
+
+  float min; // Vertical range, fit to the samples when both are 0
+  float max;
+  Color color;
+  LineChartDecimation decimation;
+} LineChartOptions;
+
+// Min and max of each of `columns` equal slices of `values`
+void DecimateMinMax(const float *values, int64_t count, int32_t columns, float *mins, float *maxs);
+// Picks `threshold` samples keeping the first and last, writing their indices and values. Returns how many were written
+int32_t DecimateLttb(const float *values, int64_t count, int32_t threshold, int64_t *indices, float *picked);
+void LineChartDeclare(LineChartOptions options);
+#define LineChart(...) LineChartDeclare((LineChartOptions){__VA_ARGS__})
+
+/* Sparkline - A tiny line chart for table cells. Sparklines aren't drawn where their command comes
+   up, the renderer collects them and draws them as one line batch at the next scissor change, or
+   before anything drawn later overlaps one of them so paint order holds. A column of 500 rows costs
+   about one draw call. Samples aren't copied, `values` must stay valid until the frame is rendered.
+   Longer slices than the cell is wide are drawn as each pixel column's min/max.
+*/
+typedef struct {
+  char *id;
+  char *w;
+  char *h;
+  Clay_Color bg;
+
+  const float *values;
+  int32_t count;
+  float min; // Vertical range, fit to the samples when both are 0
+  float max;
+  Clay_Color color;
+} SparklineOptions;
+
+void SparklineDeclare(SparklineOptions options);
+#define Sparkline(...) SparklineDeclare((SparklineOptions){__VA_ARGS__})
+
+/* DynamicTexture - A texture drawn from a CPU side pixel buffer that changes every frame, for heatmaps, spectrograms
+   or video. Write to `pixels` and mark what changed, when the element is rendered only the dirty rects are uploaded,
+   each packed into a staging buffer for `UpdateTextureRec`, which copies it before returning so one buffer is reused
+   every frame.
+*/
+#define DYNAMIC_TEXTURE_MAX_DIRTY 16
+
+struct DynamicTexture {
+  Texture2D texture;
+  int32_t width;
+  int32_t height;
+  Color *pixels;
+
+  Color *staging;
+  Rectangle dirty[DYNAMIC_TEXTURE_MAX_DIRTY]; // Never overlapping
+  int32_t dirtyCount;
+};
+
+typedef struct {
+  char *id;
+  char *w;
+  char *h;
+  Clay_Color bg;
+  DynamicTexture *texture; // Required
+} DynamicTextureOptions;
+
+void DynamicTextureInit(DynamicTexture *texture, int32_t width, int32_t height);
+void DynamicTextureFree(DynamicTexture *texture);
+// Overlapping rects are merged, past `DYNAMIC_TEXTURE_MAX_DIRTY` the closest ones are
+void DynamicTextureMarkDirty(DynamicTexture *texture, int32_t x, int32_t y, int32_t width, int32_t height);
+void DynamicTextureDeclare(DynamicTextureOptions options);
+#define DynamicTextureElement(...) DynamicTextureDeclare((DynamicTextureOptions){__VA_ARGS__})
+
+/* Scatter - Plots huge point clouds by binning them into a density grid at the chart's pixel size, in parallel over
+   `RenderParallelFor`, and drawing the densities through a palette as one texture. When zoomed in until no more than
+   `pointThreshold` points are in view they're drawn as points instead.
+*/
+typedef struct {
+  DynamicTexture texture;
+  atomic_uint *grid;
+} ScatterState;
+
+typedef struct {
+  char *id; // Required, the chart is sized from its last layout
+  char *w;
+  char *h;
+  Clay_Color bg;
+
+  const float *xs;
+  const float *ys;
+  int64_t count;
+  float minX; // Visible range, fit to the points when all are 0
+  float maxX;
+  float minY;
+  float maxY;
+
+  Color color;            // Of single points
+  const Color *palette;   // 256 colors from lowest to highest density, defaults to a dark blue to white ramp
+  int32_t pointThreshold; // Defaults to 20000
+  ScatterState *state;    // Required, zero initialized
+} ScatterOptions;
+
+void ScatterDeclare(ScatterOptions options);
+void ScatterFree(ScatterState *state);
+#define Scatter(...) ScatterDeclare((ScatterOptions){__VA_ARGS__})
+
+/* FlameGraph - Draws profiler output given as a flat array of nodes, depth 0 at the top. Nodes are indexed once by
+   depth then start, and since nodes at one depth don't overlap their ends are sorted too, so the nodes in view are
+   found with a binary search per depth. Nodes narrower than a pixel are merged into aggregate blocks a pixel column at
+   a time, skipping over the rest of the column with another binary search, so a frame costs about
+   `width * depths * log n` and at most a couple of blocks per pixel column whatever the profile's size. Labels are
+   only emitted for blocks wide enough to hold them.
+*/
+typedef struct {
+  double start;
+  double width;
+  int32_t depth;
+  int32_t label; // Index into `FlameGraphOptions.labels`, or -1
+} FlameNode;
+
+typedef struct {
+  float x0;
+  float x1;
+  int32_t depth;
+  int32_t node; // -1 for an aggregate
+} FlameBlock;
+
+typedef struct {
+  const FlameNode *nodes; // Not copied, has to outlive the state
+  int32_t count;
+  int32_t *order; // Node indices by depth then start
+  double *starts; // In `order`
+  double *ends;
+  int32_t *depthStarts; // Depth `d` is `order[depthStarts[d], depthStarts[d + 1])`
+  int32_t depthCount;
+  double minStart;
+  double maxEnd;
+
+  FlameBlock *blocks; // Scratch reused between frames
+  int32_t blockCapacity;
+  float *labelWidths; // Cached per label, negative until measured
+  const Clay_String *labelWidthLabels; // Labels the cache was measured from
+  int32_t labelWidthCount;
+  uint16_t labelFontId;
+  uint16_t labelFontSize;
+} FlameGraphState;
+
+typedef struct {
+  char *id; // Required, blocks are laid out at the width of the last layout
+  char *w;
+  Clay_Color bg;
+  FlameGraphState *state; // Required
+
+  Clay_String *labels; // Widths are cached per array, pass a new one when the text changes
+  int32_t labelCount;
+  double from; // Visible range, the whole profile when both are 0
+  double to;
+  float rowHeight; // Defaults to 18, the element is `depthCount * rowHeight` high
+  uint16_t fontId;
+  uint16_t fontSize; // Defaults to 14
+  Clay_Color textColor;
+  Color aggregateColor; // Defaults to gray
+} FlameGraphOptions;
+
+void FlameGraphInit(FlameGraphState *state, const FlameNode *nodes, int32_t count);
+void FlameGraphFree(FlameGraphState *state);
+void FlameGraphDeclare(FlameGraphOptions options);
+#define FlameGraph(...) FlameGraphDeclare((FlameGraphOptions){__VA_ARGS__})
+
+/* GlyphGrid - A fixed size grid of monospace cells, each a codepoint with its own colors, for terminals and REPLs.
+   The whole grid is one custom element drawn as a single batch of background runs followed by a single batch of glyph
+   quads. Quads are cached per row relative to the grid, so only rows written to since the last frame are rebuilt.
+*/
+typedef struct {
+  uint32_t codepoint; // 0 or ' ' for no glyph
+  Color fg;
+  Color bg;
+} GlyphCell;
+
+typedef struct {
+  float x;
+  float y;
+  float width;
+  float height;
+  Rectangle source; // Atlas rect, unused for backgrounds
+  Color color;
+} GlyphQuad;
+
+struct GlyphGridState {
+  int32_t columns;
+  int32_t rows;
+  GlyphCell *cells;
+  uint16_t fontId;
+  uint16_t fontSize;
+
+  // Cache, rebuilt for dirty rows when drawn. Row `y` has its backgrounds at `quads[y * columns * 2]` and its glyphs
+  // right after them
+  float cellWidth;
+  float cellHeight;
+  bool *dirtyRows;
+  GlyphQuad *quads;
+  int32_t *backgroundCounts;
+  int32_t *glyphCounts;
+};
+
+void GlyphGridInit(GlyphGridState *state, int32_t columns, int32_t rows, uint16_t fontId, uint16_t fontSize);
+void GlyphGridFree(GlyphGridState *state);
+void GlyphGridClear(GlyphGridState *state, Color bg);
+void GlyphGridSet(GlyphGridState *state, int32_t x, int32_t y, uint32_t codepoint, Color fg, Color bg);
+// Writes UTF-8 `text` from `x` on row `y`, clipped to the row, and returns the column after the last cell written
+int32_t GlyphGridPrint(GlyphGridState *state, int32_t x, int32_t y, const char *text, Color fg, Color bg);
+void GlyphGridDeclare(GlyphGridState *state);
+#define GlyphGrid(state) GlyphGridDeclare(state)
 
 // Colors
 #define CHARCOCK (Clay_Color){12, 8, 6, 255}
@@ -497,6 +1637,8 @@ static Clay_ElementDeclaration marginDefaultOptions = {.layout = {.sizing = {.wi
 #define NONE (Clay_Color){0, 0, 0, 0}
 
 #ifdef RENDERER_IMPLEMENTATION
+#include "rlgl.h"
+
 /*
   Default raylib_renderer.c stuff
   Source: https://github.com/nicbarker/clay/blob/main/renderers/raylib/clay_renderer_raylib.c
@@ -547,319 +1689,4347 @@ Ray GetScreenToWorldPointWithZDistance(Vector2 position, Camera camera, int scre
   return ray;
 }
 
-static inline Clay_Dimensions Raylib_MeasureText(Clay_StringSlice text, Clay_TextElementConfig *config, void *userData) {
-  // Measure string size for Font
-  Clay_Dimensions textSize = {0};
-
-  float maxTextWidth = 0.0f;
-  float lineTextWidth = 0;
+#ifdef RENDERER_ATTRIBUTION
+/* Per element cost attribution */
 
-  float textHeight = config->fontSize;
-  Font *fonts = (Font *)userData;
-  Font fontToUse = fonts[config->fontId];
-  // Font failed to load, likely the fonts are in the wrong place relative to the execution dir.
-  // RayLib ships with a default font, so we can continue with that built in one.
-  if (!fontToUse.glyphs) {
-    fontToUse = GetFontDefault();
-  }
+static struct {
+  AttributionEntry entries[ATTRIBUTION_MAX_ENTRIES]; // 0 is for elements without a named ancestor
+  int32_t entryCount;
+  AttributionEntry *stack[ATTRIBUTION_MAX_DEPTH];
+  int32_t depth;
+  uint64_t startFrame;
+} attribution = {.entryCount = 1};
 
-  float scaleFactor = config->fontSize / (float)fontToUse.baseSize;
+static AttributionEntry *attributionCurrent(void) {
+  return attribution.depth > 0 ? attribution.stack[attribution.depth - 1] : &attribution.entries[0];
+}
 
-  for (int i = 0; i < text.length; ++i) {
-    if (text.chars[i] == '\n') {
-      maxTextWidth = fmax(maxTextWidth, lineTextWidth);
-      lineTextWidth = 0;
-      continue;
-    }
-    int index = text.chars[i] - 32;
-    if (fontToUse.glyphs[index].advanceX != 0) lineTextWidth += fontToUse.glyphs[index].advanceX;
-    else lineTextWidth += (fontToUse.recs[index].width + fontToUse.glyphs[index].offsetX);
+static AttributionEntry *attributionFind(const char *id) {
+  uint32_t hash = Clay__HashString(toClayString((char *)id), 0, 0).id;
+  for (int32_t i = 1; i < attribution.entryCount; i++) {
+    if (attribution.entries[i].hash == hash) return &attribution.entries[i];
   }
 
-  maxTextWidth = fmax(maxTextWidth, lineTextWidth);
+  // Once full every new id goes to the unnamed bucket
+  if (attribution.entryCount == ATTRIBUTION_MAX_ENTRIES) return &attribution.entries[0];
 
-  textSize.width = maxTextWidth * scaleFactor;
-  textSize.height = textHeight;
+  // Ids are often built per frame in the arena, so the table keeps its own copy
+  size_t length = strlen(id) + 1;
+  char *copy = (char *)malloc(length);
+  memcpy(copy, id, length);
+  AttributionEntry *entry = &attribution.entries[attribution.entryCount++];
+  *entry = (AttributionEntry){.id = copy, .hash = hash};
+  return entry;
+}
 
-  return textSize;
+void AttributionPush(const char *id) {
+  assert(attribution.depth < ATTRIBUTION_MAX_DEPTH && "Attribution stack too deep");
+  attribution.stack[attribution.depth] = id ? attributionFind(id) : attributionCurrent();
+  attribution.depth++;
 }
 
-void Clay_Raylib_Initialize(int width, int height, const char *title, unsigned int flags) {
+void AttributionPop(void) {
+  attribution.depth--;
+}
+
+Clay_TextElementConfig *AttributionTextConfig(Clay_TextElementConfig *textConfig) {
+  Clay_TextElementConfig config = *textConfig;
+  config.userData = attributionCurrent();
+  return Clay__StoreTextElementConfig(config);
+}
+
+static AttributionEntry *attributionCommandEntry(Clay_RenderCommand *renderCommand) {
+  return renderCommand->userData ? (AttributionEntry *)renderCommand->userData : &attribution.entries[0];
+}
+
+// Draw calls follow the raylib functions `Clay_Raylib_Render` calls per command, vertices come from the render counters
+static void attributionRecordCommand(Clay_RenderCommand *renderCommand, uint32_t vertices) {
+  AttributionEntry *entry = attributionCommandEntry(renderCommand);
+  entry->commands++;
+  entry->vertices += vertices;
+
+  switch (renderCommand->commandType) {
+  case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+  case CLAY_RENDER_COMMAND_TYPE_TEXT:
+  case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+  case CLAY_RENDER_COMMAND_TYPE_CUSTOM: {
+    entry->drawCalls++;
+    break;
+  }
+  case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+    Clay_BorderRenderData *config = &renderCommand->renderData.border;
+    float widths[4] = {config->width.left, config->width.right, config->width.top, config->width.bottom};
+    float radii[4] = {config->cornerRadius.topLeft, config->cornerRadius.topRight, config->cornerRadius.bottomLeft, config->cornerRadius.bottomRight};
+    for (int32_t i = 0; i < 4; i++) {
+      if (widths[i] > 0) entry->drawCalls++;
+      if (radii[i] > 0) entry->drawCalls++;
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+int32_t GetAttributionTop(AttributionEntry *entries, int32_t count) {
+  // Selection by render time, the table is small enough that sorting isn't worth an allocation
+  bool taken[ATTRIBUTION_MAX_ENTRIES] = {0};
+  int32_t written = 0;
+  for (; written < count && written < attribution.entryCount; written++) {
+    int32_t best = -1;
+    for (int32_t i = 0; i < attribution.entryCount; i++) {
+      if (taken[i]) continue;
+      if (best == -1 || attribution.entries[i].renderTime > attribution.entries[best].renderTime) best = i;
+    }
+    taken[best] = true;
+    entries[written] = attribution.entries[best];
+  }
+  return written;
+}
+
+void ResetAttribution(void) {
+  for (int32_t i = 0; i < attribution.entryCount; i++) {
+    AttributionEntry *entry = &attribution.entries[i];
+    *entry = (AttributionEntry){.id = entry->id, .hash = entry->hash};
+  }
+  attribution.startFrame = renderer.frameIndex;
+}
+
+static double attributionFrames(void) {
+  uint64_t frames = renderer.frameIndex - attribution.startFrame;
+  return frames ? (double)frames : 1.0;
+}
+
+bool ExportAttribution(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (!file) return false;
+
+  double frames = attributionFrames();
+  fprintf(file, "id,elements,commands,draw_calls,vertices,text_bytes,render_ms\n");
+  for (int32_t i = 0; i < attribution.entryCount; i++) {
+    AttributionEntry *entry = &attribution.entries[i];
+    fprintf(file,
+            "%s,%.1f,%.1f,%.1f,%.1f,%.1f,%.4f\n",
+            entry->id ? entry->id : "(unnamed)",
+            entry->elements / frames,
+            entry->commands / frames,
+            entry->drawCalls / frames,
+            entry->vertices / frames,
+            entry->textBytes / frames,
+            entry->renderTime * 1000.0 / frames);
+  }
+
+  fclose(file);
+  return true;
+}
+
+void DrawAttributionHud(int32_t x, int32_t y, int32_t count) {
+  AttributionEntry top[16];
+  count = GetAttributionTop(top, CLAY__MIN(count, 16));
+
+  double frames = attributionFrames();
+  char line[160];
+  DrawRectangle(x, y, 560, 20 * (count + 1) + 8, (Color){0, 0, 0, 200});
+  DrawText("id                      render ms   draws   verts  text B", x + 6, y + 4, 16, WHITE);
+  for (int32_t i = 0; i < count; i++) {
+    snprintf(line,
+             sizeof(line),
+             "%-22.22s %10.3f %7.0f %7.0f %7.0f",
+             top[i].id ? top[i].id : "(unnamed)",
+             top[i].renderTime * 1000.0 / frames,
+             top[i].drawCalls / frames,
+             top[i].vertices / frames,
+             top[i].textBytes / frames);
+    DrawText(line, x + 6, y + 4 + 20 * (i + 1), 16, WHITE);
+  }
+}
+#endif
+
+static inline Clay_Dimensions Raylib_MeasureText(Clay_StringSlice text, Clay_TextElementConfig *config, void *userData) {
+  // Measure string size for Font
+  Clay_Dimensions textSize = {0};
+
+  float maxTextWidth = 0.0f;
+  float lineTextWidth = 0;
+
+  float textHeight = config->fontSize;
+  Font *fonts = (Font *)userData;
+  Font fontToUse = fonts[config->fontId];
+  // Font failed to load, likely the fonts are in the wrong place relative to the execution dir.
+  // RayLib ships with a default font, so we can continue with that built in one.
+  if (!fontToUse.glyphs) {
+    fontToUse = GetFontDefault();
+  }
+
+  float scaleFactor = config->fontSize / (float)fontToUse.baseSize;
+
+  // Clay only calls this on a miss of its word measurement cache
+  RENDERER_PROBE2(measure_miss, text.length, config->fontId);
+#ifdef RENDERER_ATTRIBUTION
+  attributionCurrent()->textBytes += text.length;
+#endif
+
+  for (int i = 0; i < text.length; ++i) {
+    if (text.chars[i] == '\n') {
+      maxTextWidth = fmax(maxTextWidth, lineTextWidth);
+      lineTextWidth = 0;
+      continue;
+    }
+    int index = text.chars[i] - 32;
+    if (fontToUse.glyphs[index].advanceX != 0) lineTextWidth += fontToUse.glyphs[index].advanceX;
+    else lineTextWidth += (fontToUse.recs[index].width + fontToUse.glyphs[index].offsetX);
+  }
+
+  maxTextWidth = fmax(maxTextWidth, lineTextWidth);
+
+  textSize.width = maxTextWidth * scaleFactor;
+  textSize.height = textHeight;
+
+  return textSize;
+}
+
+void Clay_Raylib_Initialize(int width, int height, const char *title, unsigned int flags) {
   SetConfigFlags(flags);
   InitWindow(width, height, title);
 }
 
-void Clay_Raylib_Render(Clay_RenderCommandArray renderCommands, Font *fonts) {
-  for (int j = 0; j < renderCommands.length; j++) {
-    Clay_RenderCommand *renderCommand = Clay_RenderCommandArray_Get(&renderCommands, j);
-    Clay_BoundingBox boundingBox = renderCommand->boundingBox;
-    switch (renderCommand->commandType) {
-    case CLAY_RENDER_COMMAND_TYPE_TEXT: {
-      // Raylib uses standard C strings so isn't compatible with cheap slices, we need to clone the string to append null terminator
-      Clay_TextRenderData *textData = &renderCommand->renderData.text;
-      char *cloned = (char *)malloc(textData->stringContents.length + 1);
-      memcpy(cloned, textData->stringContents.chars, textData->stringContents.length);
-      cloned[textData->stringContents.length] = '\0';
-      Font fontToUse = fonts[textData->fontId];
-      DrawTextEx(fontToUse, cloned, (Vector2){boundingBox.x, boundingBox.y}, (float)textData->fontSize, (float)textData->letterSpacing, CLAY_COLOR_TO_RAYLIB_COLOR(textData->textColor));
-      free(cloned);
-      break;
+// Width of a single line, the same way `Raylib_MeasureText` measures it
+static float glyphAdvance(Font font, int codepoint) {
+  // Fonts loaded from 32 up have printable ASCII in order, anything else goes through raylib's lookup and its `?`
+  int index = codepoint - 32;
+  if (index < 0 || index >= font.glyphCount || font.glyphs[index].value != codepoint) index = GetGlyphIndex(font, codepoint);
+  if (font.glyphs[index].advanceX != 0) return (float)font.glyphs[index].advanceX;
+  return font.recs[index].width + font.glyphs[index].offsetX;
+}
+
+// Unscaled width of a character at `chars`, setting how many bytes it took. Tabs are 4 spaces and other control
+// characters a space, UTF-8 is decoded like `DrawTextEx` does but never past `length`
+static float characterAdvance(Font font, const char *chars, int32_t length, int32_t *size) {
+  unsigned char c = (unsigned char)chars[0];
+  *size = 1;
+  if (c == '\t') return 4 * glyphAdvance(font, ' ');
+  if (c < 32 || c == 127) return glyphAdvance(font, ' ');
+  if (c < 128) return glyphAdvance(font, c);
+  int32_t expected = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+  if (expected > length) return glyphAdvance(font, '?');
+  int decoded = 1;
+  int codepoint = GetCodepointNext(chars, &decoded);
+  *size = CLAY__MAX(1, decoded);
+  return glyphAdvance(font, codepoint);
+}
+
+static float fontLineWidth(Font font, float fontSize, const char *chars, int32_t length) {
+  if (!font.glyphs) font = GetFontDefault();
+  float width = 0;
+  for (int32_t i = 0, size; i < length; i += size) width += characterAdvance(font, chars + i, length - i, &size);
+  return width * fontSize / (float)font.baseSize;
+}
+
+static float measureLineWidth(Font *fonts, uint16_t fontId, float fontSize, const char *chars, int32_t length) {
+  return fontLineWidth(fonts[fontId], fontSize, chars, length);
+}
+
+// Scratch buffer for null terminating text slices, grows to the longest string seen so rendering doesn't allocate
+static char *textScratch = NULL;
+static size_t textScratchCapacity = 0;
+
+static char *terminateText(Clay_StringSlice text) {
+  if ((size_t)text.length + 1 > textScratchCapacity) {
+    size_t capacity = textScratchCapacity ? textScratchCapacity : 256;
+    while (capacity < (size_t)text.length + 1) capacity *= 2;
+    textScratch = (char *)realloc(textScratch, capacity);
+    textScratchCapacity = capacity;
+  }
+  memcpy(textScratch, text.chars, text.length);
+  textScratch[text.length] = '\0';
+  return textScratch;
+}
+
+/* Render counters */
+// The renderer's model of its rlgl batch. Like rlgl, a change of mode or texture starts another draw call and the batch
+// is flushed when it fills up, on a scissor or 3D mode change and at the end of the frame
+static struct {
+  rlRenderBatch batch;
+  int32_t capacity; // Vertices
+  int32_t vertices; // Since the last flush
+  int32_t mode;
+  uint32_t textureId;
+} renderBatch = {0};
+
+static void countFlush(void) {
+  // Flushing an empty batch doesn't draw anything
+  if (renderBatch.vertices == 0) return;
+  renderer.counters.batchFlushes++;
+  renderBatch.vertices = 0;
+}
+
+static void countScissor(void) {
+  renderer.counters.scissorChanges++;
+  countFlush();
+}
+
+// What doesn't fit in the batch goes into the next one after a flush
+static void countDraw(int32_t mode, uint32_t textureId, int32_t vertices) {
+  assert(renderBatch.capacity > 0);
+  while (vertices > 0) {
+    if (renderBatch.vertices >= renderBatch.capacity) countFlush();
+    if (renderBatch.vertices == 0 || mode != renderBatch.mode || textureId != renderBatch.textureId) {
+      renderer.counters.drawCalls++;
+      if (renderBatch.vertices > 0 && textureId != renderBatch.textureId) renderer.counters.textureBinds++;
+      renderBatch.mode = mode;
+      renderBatch.textureId = textureId;
+    }
+    int32_t added = CLAY__MIN(vertices, renderBatch.capacity - renderBatch.vertices);
+    renderBatch.vertices += added;
+    renderer.counters.vertices += added;
+    vertices -= added;
+  }
+}
+
+static void countShapes(int32_t quads) {
+  countDraw(RL_QUADS, GetShapesTexture().id, quads * 4);
+}
+
+// Raylib draws a quad per codepoint, except for the whitespace it only advances over
+static void countText(Font font, const char *chars, int32_t length) {
+  int32_t glyphs = 0;
+  for (int32_t i = 0; i < length; i++) {
+    unsigned char c = (unsigned char)chars[i];
+    if ((c & 0xc0) != 0x80 && c != ' ' && c != '\t' && c != '\n') glyphs++;
+  }
+  countDraw(RL_QUADS, font.texture.id, glyphs * 4);
+}
+
+// Quads raylib tessellates a rounded rectangle into, each corner packs two segments per quad
+static int32_t roundedRectangleQuads(int32_t segments) {
+  return 4 * ((segments + 1) / 2) + 5;
+}
+
+// Quads in a raylib ring, without a hole it's a circle sector that packs two segments per quad
+static int32_t ringQuads(float innerRadius, int32_t segments) {
+  return innerRadius > 0 ? segments : (segments + 1) / 2;
+}
+
+// Meshes are drawn right away instead of going through the batch
+static void countModel(Model model) {
+  for (int32_t i = 0; i < model.meshCount; i++) {
+    renderer.counters.drawCalls++;
+    renderer.counters.vertices += model.meshes[i].vertexCount;
+  }
+}
+
+RenderCounters GetRenderCounters(void) {
+  return renderer.frameCounters;
+}
+
+void DrawRenderCountersHud(int32_t x, int32_t y) {
+  RenderCounters counters = renderer.frameCounters;
+  char line[160];
+  snprintf(line,
+           sizeof(line),
+           "draws %u  verts %u  textures %u  scissors %u  flushes %u",
+           counters.drawCalls,
+           counters.vertices,
+           counters.textureBinds,
+           counters.scissorChanges,
+           counters.batchFlushes);
+  DrawRectangle(x, y, MeasureText(line, 16) + 12, 24, (Color){0, 0, 0, 200});
+  DrawText(line, x + 6, y + 4, 16, WHITE);
+}
+
+/* Glyph grid */
+void GlyphGridInit(GlyphGridState *state, int32_t columns, int32_t rows, uint16_t fontId, uint16_t fontSize) {
+  *state = (GlyphGridState){.columns = columns, .rows = rows, .fontId = fontId, .fontSize = fontSize};
+  state->cells = (GlyphCell *)calloc(columns * rows, sizeof(GlyphCell));
+  state->dirtyRows = (bool *)malloc(rows * sizeof(bool));
+  state->quads = (GlyphQuad *)malloc(columns * rows * 2 * sizeof(GlyphQuad));
+  state->backgroundCounts = (int32_t *)calloc(rows, sizeof(int32_t));
+  state->glyphCounts = (int32_t *)calloc(rows, sizeof(int32_t));
+  memset(state->dirtyRows, true, rows * sizeof(bool));
+}
+
+void GlyphGridFree(GlyphGridState *state) {
+  free(state->cells);
+  free(state->dirtyRows);
+  free(state->quads);
+  free(state->backgroundCounts);
+  free(state->glyphCounts);
+  *state = (GlyphGridState){0};
+}
+
+void GlyphGridClear(GlyphGridState *state, Color bg) {
+  for (int32_t i = 0; i < state->columns * state->rows; i++) {
+    state->cells[i] = (GlyphCell){.bg = bg};
+  }
+  memset(state->dirtyRows, true, state->rows * sizeof(bool));
+}
+
+void GlyphGridSet(GlyphGridState *state, int32_t x, int32_t y, uint32_t codepoint, Color fg, Color bg) {
+  if (x < 0 || y < 0 || x >= state->columns || y >= state->rows) return;
+  state->cells[y * state->columns + x] = (GlyphCell){.codepoint = codepoint, .fg = fg, .bg = bg};
+  state->dirtyRows[y] = true;
+}
+
+int32_t GlyphGridPrint(GlyphGridState *state, int32_t x, int32_t y, const char *text, Color fg, Color bg) {
+  while (*text && x < state->columns) {
+    int32_t size = 0;
+    GlyphGridSet(state, x++, y, (uint32_t)GetCodepointNext(text, &size), fg, bg);
+    text += size;
+  }
+  return x;
+}
+
+static bool colorEqual(Color a, Color b) {
+  return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+static void glyphGridBuildRow(GlyphGridState *state, Font font, int32_t y) {
+  GlyphCell *cells = &state->cells[y * state->columns];
+  GlyphQuad *backgrounds = &state->quads[y * state->columns * 2];
+  GlyphQuad *glyphs = backgrounds + state->columns;
+  float scale = (float)state->fontSize / font.baseSize;
+  float top = y * state->cellHeight;
+  int32_t backgroundCount = 0;
+  int32_t glyphCount = 0;
+  int32_t lastBackgroundColumn = -2;
+
+  for (int32_t x = 0; x < state->columns; x++) {
+    GlyphCell cell = cells[x];
+    float left = x * state->cellWidth;
+
+    // Neighbouring cells with the same background share one quad
+    if (cell.bg.a > 0) {
+      if (lastBackgroundColumn == x - 1 && colorEqual(backgrounds[backgroundCount - 1].color, cell.bg)) {
+        backgrounds[backgroundCount - 1].width += state->cellWidth;
+      } else {
+        backgrounds[backgroundCount++] = (GlyphQuad){.x = left, .y = top, .width = state->cellWidth, .height = state->cellHeight, .color = cell.bg};
+      }
+      lastBackgroundColumn = x;
+    }
+
+    if (cell.codepoint == 0 || cell.codepoint == ' ' || cell.fg.a == 0) continue;
+    int32_t index = GetGlyphIndex(font, (int)cell.codepoint);
+    Rectangle source = font.recs[index];
+    glyphs[glyphCount++] = (GlyphQuad){
+        .x = left + (font.glyphs[index].offsetX - font.glyphPadding) * scale,
+        .y = top + (font.glyphs[index].offsetY - font.glyphPadding) * scale,
+        .width = (source.width + 2.0f * font.glyphPadding) * scale,
+        .height = (source.height + 2.0f * font.glyphPadding) * scale,
+        .source = {source.x - font.glyphPadding, source.y - font.glyphPadding, source.width + 2.0f * font.glyphPadding, source.height + 2.0f * font.glyphPadding},
+        .color = cell.fg,
+    };
+  }
+
+  state->backgroundCounts[y] = backgroundCount;
+  state->glyphCounts[y] = glyphCount;
+  state->dirtyRows[y] = false;
+}
+
+static void glyphGridQuads(GlyphQuad *quads, int32_t count, float originX, float originY, Texture2D *texture) {
+  for (int32_t i = 0; i < count; i++) {
+    GlyphQuad quad = quads[i];
+    float x = originX + quad.x;
+    float y = originY + quad.y;
+    rlCheckRenderBatchLimit(4);
+    rlColor4ub(quad.color.r, quad.color.g, quad.color.b, quad.color.a);
+    if (texture) {
+      float u0 = quad.source.x / texture->width;
+      float v0 = quad.source.y / texture->height;
+      float u1 = (quad.source.x + quad.source.width) / texture->width;
+      float v1 = (quad.source.y + quad.source.height) / texture->height;
+      rlTexCoord2f(u0, v0);
+      rlVertex2f(x, y);
+      rlTexCoord2f(u0, v1);
+      rlVertex2f(x, y + quad.height);
+      rlTexCoord2f(u1, v1);
+      rlVertex2f(x + quad.width, y + quad.height);
+      rlTexCoord2f(u1, v0);
+      rlVertex2f(x + quad.width, y);
+    } else {
+      rlVertex2f(x, y);
+      rlVertex2f(x, y + quad.height);
+      rlVertex2f(x + quad.width, y + quad.height);
+      rlVertex2f(x + quad.width, y);
+    }
+  }
+}
+
+static void glyphGridDraw(GlyphGridState *state, Font font, float originX, float originY) {
+  for (int32_t y = 0; y < state->rows; y++) {
+    if (state->dirtyRows[y]) glyphGridBuildRow(state, font, y);
+  }
+
+  int32_t backgroundCount = 0;
+  int32_t glyphCount = 0;
+  for (int32_t y = 0; y < state->rows; y++) {
+    backgroundCount += state->backgroundCounts[y];
+    glyphCount += state->glyphCounts[y];
+  }
+  countDraw(RL_QUADS, rlGetTextureIdDefault(), backgroundCount * 4);
+  countDraw(RL_QUADS, font.texture.id, glyphCount * 4);
+
+  // Every background first so no glyph gets covered by the next cell's background
+  rlSetTexture(rlGetTextureIdDefault());
+  rlBegin(RL_QUADS);
+  for (int32_t y = 0; y < state->rows; y++) {
+    glyphGridQuads(&state->quads[y * state->columns * 2], state->backgroundCounts[y], originX, originY, NULL);
+  }
+  rlEnd();
+
+  rlSetTexture(font.texture.id);
+  rlBegin(RL_QUADS);
+  for (int32_t y = 0; y < state->rows; y++) {
+    glyphGridQuads(&state->quads[y * state->columns * 2 + state->columns], state->glyphCounts[y], originX, originY, &font.texture);
+  }
+  rlEnd();
+  rlSetTexture(0);
+}
+
+/* Text input */
+void TextInputInit(TextInputState *state, uint16_t fontId, uint16_t fontSize) {
+  *state = (TextInputState){
+      .capacity = 64,
+      .gapEnd = 64,
+      .fontId = fontId,
+      .fontSize = fontSize,
+      .textColor = {235, 235, 235, 255},
+      .selectionColor = {70, 110, 180, 255},
+  };
+  state->buffer = (char *)malloc(state->capacity);
+  state->advancesCapacity = state->capacity + 1;
+  state->advances = (float *)malloc(sizeof(float) * state->advancesCapacity);
+  state->advances[0] = 0;
+}
+
+void TextInputFree(TextInputState *state) {
+  free(state->buffer);
+  free(state->advances);
+  *state = (TextInputState){0};
+}
+
+int32_t TextInputLength(TextInputState *state) {
+  return state->capacity - (state->gapEnd - state->gapStart);
+}
+
+static char textInputAt(TextInputState *state, int32_t index) {
+  return index < state->gapStart ? state->buffer[index] : state->buffer[index + state->gapEnd - state->gapStart];
+}
+
+static void textInputMoveGap(TextInputState *state, int32_t position) {
+  if (position < state->gapStart) {
+    int32_t count = state->gapStart - position;
+    memmove(state->buffer + state->gapEnd - count, state->buffer + position, count);
+    state->gapStart -= count;
+    state->gapEnd -= count;
+  } else if (position > state->gapStart) {
+    int32_t count = position - state->gapStart;
+    memmove(state->buffer + state->gapStart, state->buffer + state->gapEnd, count);
+    state->gapStart += count;
+    state->gapEnd += count;
+  }
+}
+
+static void textInputReserve(TextInputState *state, int32_t count) {
+  if (state->gapEnd - state->gapStart >= count) return;
+
+  int32_t length = TextInputLength(state);
+  int32_t capacity = state->capacity;
+  while (capacity - length < count) capacity *= 2;
+  int32_t tail = state->capacity - state->gapEnd;
+  state->buffer = (char *)realloc(state->buffer, capacity);
+  memmove(state->buffer + capacity - tail, state->buffer + state->gapEnd, tail);
+  state->gapEnd = capacity - tail;
+  state->capacity = capacity;
+
+  state->advancesCapacity = capacity + 1;
+  state->advances = (float *)realloc(state->advances, sizeof(float) * state->advancesCapacity);
+}
+
+static void textInputInvalidate(TextInputState *state, int32_t from) {
+  state->advancesValid = CLAY__MIN(state->advancesValid, from);
+}
+
+static void textInputDelete(TextInputState *state, int32_t start, int32_t end) {
+  if (start >= end) return;
+  textInputMoveGap(state, start);
+  state->gapEnd += end - start;
+  textInputInvalidate(state, start);
+}
+
+static void textInputInsert(TextInputState *state, int32_t position, const char *chars, int32_t count) {
+  textInputReserve(state, count);
+  textInputMoveGap(state, position);
+  memcpy(state->buffer + state->gapStart, chars, count);
+  state->gapStart += count;
+  textInputInvalidate(state, position);
+}
+
+// Copied around the gap rather than moving it to the end, which the next edit at the caret would have to move back
+Clay_String TextInputText(TextInputState *state) {
+  int32_t length = TextInputLength(state);
+  char *chars = (char *)ArenaAlloc(&renderer.frameArena, length + 1);
+  memcpy(chars, state->buffer, state->gapStart);
+  memcpy(chars + state->gapStart, state->buffer + state->gapEnd, length - state->gapStart);
+  return (Clay_String){.length = length, .chars = chars};
+}
+
+void TextInputSetText(TextInputState *state, Clay_String text) {
+  textInputDelete(state, 0, TextInputLength(state));
+  if (text.length > 0) textInputInsert(state, 0, text.chars, text.length);
+  state->caret = state->anchor = text.length;
+}
+
+// x of byte `index`, extending the cached prefix up to it
+static float textInputAdvance(TextInputState *state, int32_t index) {
+  for (; state->advancesValid < index; state->advancesValid++) {
+    char c = textInputAt(state, state->advancesValid);
+    state->advances[state->advancesValid + 1] = state->advances[state->advancesValid] + measureLineWidth(renderer.fonts, state->fontId, state->fontSize, &c, 1);
+  }
+  return state->advances[index];
+}
+
+// First byte whose x is past `x`, extending the cached prefix only as far as needed
+static int32_t textInputIndexAt(TextInputState *state, float x) {
+  int32_t length = TextInputLength(state);
+  int32_t index = 0;
+  if (state->advances[state->advancesValid] > x) {
+    int32_t low = 0;
+    int32_t high = state->advancesValid;
+    while (low < high) {
+      int32_t middle = (low + high) / 2;
+      if (state->advances[middle] <= x) low = middle + 1;
+      else high = middle;
+    }
+    index = low;
+  } else {
+    index = state->advancesValid;
+    while (index < length && textInputAdvance(state, index) <= x) index++;
+  }
+  return CLAY__MIN(index, length);
+}
+
+// Caret position closest to `x`, before the byte under it when `x` is on its left half
+static int32_t textInputCaretAt(TextInputState *state, float x) {
+  int32_t index = textInputIndexAt(state, x);
+  if (index > 0 && x < (textInputAdvance(state, index - 1) + textInputAdvance(state, index)) / 2) index--;
+  return index;
+}
+
+// Scissors to `box` inside the current clip, `endClip` puts the current clip back
+static void beginClip(Clay_BoundingBox box, Clay_BoundingBox clip) {
+  float left = fmaxf(box.x, clip.x);
+  float top = fmaxf(box.y, clip.y);
+  float right = fminf(box.x + box.width, clip.x + clip.width);
+  float bottom = fminf(box.y + box.height, clip.y + clip.height);
+  countScissor();
+  BeginScissorMode((int)roundf(left), (int)roundf(top), (int)roundf(fmaxf(0, right - left)), (int)roundf(fmaxf(0, bottom - top)));
+}
+
+// Draws a line of text as runs between control characters, which are spaced like `measureLineWidth` measures them
+// instead of drawn as `?`
+static void drawTextLine(Font font, const char *chars, int32_t length, Vector2 position, float fontSize, Color color) {
+  int32_t runStart = 0;
+  for (int32_t i = 0; i <= length; i++) {
+    if (i < length && (unsigned char)chars[i] >= 32 && chars[i] != 127) continue;
+    if (i > runStart) {
+      char *terminated = terminateText((Clay_StringSlice){.length = i - runStart, .chars = chars + runStart});
+      DrawTextEx(font, terminated, position, fontSize, 0, color);
+      countText(font, chars + runStart, i - runStart);
+      position.x += fontLineWidth(font, fontSize, chars + runStart, i - runStart);
+    }
+    if (i < length) position.x += fontLineWidth(font, fontSize, chars + i, 1);
+    runStart = i + 1;
+  }
+}
+
+static void endClip(Clay_BoundingBox clip, Clay_BoundingBox screen) {
+  countScissor();
+  if (memcmp(&clip, &screen, sizeof(Clay_BoundingBox)) == 0) EndScissorMode();
+  else BeginScissorMode((int)roundf(clip.x), (int)roundf(clip.y), (int)roundf(clip.width), (int)roundf(clip.height));
+}
+
+static void textInputDrawRange(TextInputState *state, Font font, int32_t start, int32_t end, float x, float y) {
+  if (start >= end) return;
+  const char *chars = start < state->gapStart ? state->buffer + start : state->buffer + start + state->gapEnd - state->gapStart;
+  drawTextLine(font, chars, end - start, (Vector2){x + state->advances[start], y}, (float)state->fontSize, CLAY_COLOR_TO_RAYLIB_COLOR(state->textColor));
+}
+
+static void textInputDraw(TextInputState *state, Font *fonts, Clay_BoundingBox box, Clay_BoundingBox clip, Clay_BoundingBox screen) {
+  state->viewWidth = box.width;
+  float x = box.x - state->scrollX;
+  int32_t first = CLAY__MAX(0, textInputIndexAt(state, state->scrollX) - 1);
+  int32_t last = textInputIndexAt(state, state->scrollX + box.width);
+  textInputAdvance(state, last);
+
+  beginClip(box, clip);
+  int32_t selectionStart = CLAY__MIN(state->caret, state->anchor);
+  int32_t selectionEnd = CLAY__MAX(state->caret, state->anchor);
+  if (selectionStart != selectionEnd) {
+    float left = textInputAdvance(state, selectionStart);
+    float right = textInputAdvance(state, selectionEnd);
+    DrawRectangleRec((Rectangle){x + left, box.y, right - left, box.height}, CLAY_COLOR_TO_RAYLIB_COLOR(state->selectionColor));
+    countShapes(1);
+  }
+
+  // Visible bytes on each side of the gap
+  textInputDrawRange(state, fonts[state->fontId], first, CLAY__MIN(last, state->gapStart), x, box.y);
+  textInputDrawRange(state, fonts[state->fontId], CLAY__MAX(first, state->gapStart), last, x, box.y);
+
+  if (state->focused) {
+    float caretX = x + textInputAdvance(state, state->caret);
+    DrawRectangleRec((Rectangle){caretX, box.y, 1, box.height}, CLAY_COLOR_TO_RAYLIB_COLOR(state->textColor));
+    countShapes(1);
+  }
+  endClip(clip, screen);
+}
+
+/* Text editor */
+// Turns `tree[1..count]` holding the values into their Fenwick tree
+static void fenwickBuildInPlace(int32_t *tree, int32_t count) {
+  tree[0] = 0;
+  for (int32_t i = 1; i <= count; i++) {
+    int32_t parent = i + (i & -i);
+    if (parent <= count) tree[parent] += tree[i];
+  }
+}
+
+static void fenwickBuild(int32_t *tree, int32_t *values, int32_t count) {
+  for (int32_t i = 1; i <= count; i++) tree[i] = values[i - 1];
+  fenwickBuildInPlace(tree, count);
+}
+
+static void fenwickAdd(int32_t *tree, int32_t count, int32_t index, int32_t delta) {
+  for (int32_t i = index + 1; i <= count; i += i & -i) tree[i] += delta;
+}
+
+// Sum of the first `index` values
+static int32_t fenwickPrefix(int32_t *tree, int32_t index) {
+  int32_t sum = 0;
+  for (int32_t i = index; i > 0; i -= i & -i) sum += tree[i];
+  return sum;
+}
+
+// Index of the value whose range holds `target`, when the values are laid end to end
+static int32_t fenwickFind(int32_t *tree, int32_t count, int32_t target) {
+  int32_t position = 0;
+  int32_t step = 1;
+  while (step * 2 <= count) step *= 2;
+  for (; step > 0; step /= 2) {
+    if (position + step <= count && tree[position + step] <= target) {
+      position += step;
+      target -= tree[position];
+    }
+  }
+  return CLAY__MIN(position, count - 1);
+}
+
+static void textEditorBuildPieceTree(TextEditorState *state) {
+  for (int32_t slot = 0; slot < state->pieceCapacity; slot++) {
+    bool gap = slot >= state->pieceGapStart && slot < state->pieceGapEnd;
+    state->pieceTree[slot + 1] = gap ? 0 : state->pieces[slot].length;
+  }
+  fenwickBuildInPlace(state->pieceTree, state->pieceCapacity);
+}
+
+// Grows the piece gap to fit `count` pieces, moving the pieces after it to the new end
+static void textEditorReservePieces(TextEditorState *state, int32_t count) {
+  if (count <= state->pieceCapacity) return;
+  int32_t after = state->pieceCapacity - state->pieceGapEnd;
+  int32_t capacity = state->pieceCapacity ? state->pieceCapacity : 64;
+  while (capacity < count) capacity *= 2;
+  state->pieces = (TextPiece *)realloc(state->pieces, sizeof(TextPiece) * capacity);
+  state->pieceTree = (int32_t *)realloc(state->pieceTree, sizeof(int32_t) * (capacity + 1));
+  memmove(&state->pieces[capacity - after], &state->pieces[state->pieceGapEnd], sizeof(TextPiece) * after);
+  state->pieceCapacity = capacity;
+  state->pieceGapEnd = capacity - after;
+  textEditorBuildPieceTree(state);
+}
+
+// Moves the piece gap to just before piece `index`, the same way as the line gap
+static void textEditorMovePieceGap(TextEditorState *state, int32_t index) {
+  int32_t gap = state->pieceGapEnd - state->pieceGapStart;
+  int32_t count = index < state->pieceGapStart ? state->pieceGapStart - index : index - state->pieceGapStart;
+  if (count == 0) return;
+  int32_t from = index < state->pieceGapStart ? index : state->pieceGapEnd;
+  int32_t to = index < state->pieceGapStart ? index + gap : state->pieceGapStart;
+
+  bool rebuild = (int64_t)count * 32 > state->pieceCapacity;
+  if (!rebuild) {
+    for (int32_t i = from; i < from + count; i++) fenwickAdd(state->pieceTree, state->pieceCapacity, i, -state->pieces[i].length);
+  }
+  memmove(&state->pieces[to], &state->pieces[from], sizeof(TextPiece) * count);
+  state->pieceGapStart = index;
+  state->pieceGapEnd = index + gap;
+
+  if (rebuild) {
+    textEditorBuildPieceTree(state);
+  } else {
+    for (int32_t i = to; i < to + count; i++) fenwickAdd(state->pieceTree, state->pieceCapacity, i, state->pieces[i].length);
+  }
+}
+
+// Slot of the piece holding `offset`, which has to be inside the text, and the offset that piece starts at
+static int32_t textEditorPieceAt(TextEditorState *state, int32_t offset, int32_t *pieceStart) {
+  // Gap slots are empty so the search never stops on one
+  int32_t slot = fenwickFind(state->pieceTree, state->pieceCapacity, offset);
+  *pieceStart = fenwickPrefix(state->pieceTree, slot);
+  return slot;
+}
+
+// Moves the piece gap to `offset`, splitting the piece that holds it
+static void textEditorPieceGapAt(TextEditorState *state, int32_t offset) {
+  if (offset == state->length) {
+    textEditorMovePieceGap(state, state->pieceCount);
+    return;
+  }
+
+  int32_t pieceStart;
+  int32_t slot = textEditorPieceAt(state, offset, &pieceStart);
+  int32_t index = slot < state->pieceGapStart ? slot : slot - (state->pieceGapEnd - state->pieceGapStart);
+  if (offset == pieceStart) {
+    textEditorMovePieceGap(state, index);
+    return;
+  }
+
+  // The head stays before the gap and the tail goes right after it
+  textEditorReservePieces(state, state->pieceCount + 1);
+  textEditorMovePieceGap(state, index + 1);
+  TextPiece *piece = &state->pieces[state->pieceGapStart - 1];
+  int32_t head = offset - pieceStart;
+  TextPiece tail = {.added = piece->added, .start = piece->start + head, .length = piece->length - head};
+  piece->length = head;
+  fenwickAdd(state->pieceTree, state->pieceCapacity, state->pieceGapStart - 1, -tail.length);
+  state->pieces[--state->pieceGapEnd] = tail;
+  fenwickAdd(state->pieceTree, state->pieceCapacity, state->pieceGapEnd, tail.length);
+  state->pieceCount++;
+}
+
+static int32_t textEditorSlot(TextEditorState *state, int32_t line) {
+  return line < state->lineGapStart ? line : line + state->lineGapEnd - state->lineGapStart;
+}
+
+static int32_t textEditorLineStart(TextEditorState *state, int32_t line) {
+  int32_t start = state->lineStarts[textEditorSlot(state, line)];
+  return line < state->lineGapStart ? start : state->length - start;
+}
+
+// Rows above `line`
+static int32_t textEditorLineRow(TextEditorState *state, int32_t line) {
+  return fenwickPrefix(state->rowTree, textEditorSlot(state, line));
+}
+
+static int32_t textEditorLineAtRow(TextEditorState *state, int32_t row) {
+  // Gap slots hold no rows so they only come back past the last row, when the gap is at the end
+  int32_t slot = fenwickFind(state->rowTree, state->lineCapacity, row);
+  if (slot >= state->lineGapEnd) slot -= state->lineGapEnd - state->lineGapStart;
+  return CLAY__MIN(slot, state->lineCount - 1);
+}
+
+static float textEditorCharWidth(TextEditorState *state, char c) {
+  return state->charWidths[(unsigned char)c & 127];
+}
+
+static void textEditorMeasureChars(TextEditorState *state) {
+  Font font = renderer.fonts[state->fontId];
+  if (!font.glyphs) return;
+  for (int32_t c = 32; c < 127; c++) {
+    char character = (char)c;
+    state->charWidths[c] = measureLineWidth(renderer.fonts, state->fontId, state->fontSize, &character, 1);
+  }
+  // Everything else is drawn as a space, except tabs that are 4 of them
+  for (int32_t c = 0; c < 32; c++) state->charWidths[c] = state->charWidths[' '];
+  state->charWidths['\t'] = state->charWidths[' '] * 4;
+  state->charWidths[127] = state->charWidths[' '];
+}
+
+void TextEditorCopy(TextEditorState *state, int32_t offset, int32_t length, char *destination) {
+  if (length <= 0) return;
+  int32_t pieceStart;
+  int32_t slot = textEditorPieceAt(state, offset, &pieceStart);
+  int32_t from = offset - pieceStart;
+  for (; length > 0; slot++) {
+    if (slot == state->pieceGapStart) slot = state->pieceGapEnd;
+    TextPiece piece = state->pieces[slot];
+    int32_t count = CLAY__MIN(piece.length - from, length);
+    memcpy(destination, (piece.added ? state->added : state->original) + piece.start + from, count);
+    destination += count;
+    length -= count;
+    from = 0;
+  }
+}
+
+static int32_t textEditorLineEnd(TextEditorState *state, int32_t line) {
+  return line + 1 < state->lineCount ? textEditorLineStart(state, line + 1) - 1 : state->length;
+}
+
+// Copies `length` bytes at `offset` into the scratch buffer
+static char *textEditorText(TextEditorState *state, int32_t offset, int32_t length) {
+  if (length > state->scratchCapacity) {
+    state->scratchCapacity = CLAY__MAX(length, state->scratchCapacity * 2);
+    state->scratch = (char *)realloc(state->scratch, state->scratchCapacity);
+  }
+  TextEditorCopy(state, offset, length, state->scratch);
+  return state->scratch;
+}
+
+// Copies `line` without its line break into the scratch buffer
+static char *textEditorLine(TextEditorState *state, int32_t line, int32_t *length) {
+  int32_t start = textEditorLineStart(state, line);
+  *length = textEditorLineEnd(state, line) - start;
+  return textEditorText(state, start, *length);
+}
+
+static int32_t textEditorLineAt(TextEditorState *state, int32_t offset) {
+  int32_t low = 0;
+  int32_t high = state->lineCount - 1;
+  while (low < high) {
+    int32_t middle = (low + high + 1) / 2;
+    if (textEditorLineStart(state, middle) <= offset) low = middle;
+    else high = middle - 1;
+  }
+  return low;
+}
+
+// Greedy wrap at the last space that fits, or mid word if there's none. Returns the row count and fills `breaks` with
+// the offset each row after the first starts at, if given
+static int32_t textEditorWrap(TextEditorState *state, const char *chars, int32_t length, int32_t *breaks, int32_t maxBreaks) {
+  if (state->wrapWidth <= 0) return 1;
+
+  int32_t rows = 1;
+  int32_t rowStart = 0;
+  int32_t lastSpace = -1;
+  float x = 0;
+  for (int32_t i = 0; i < length; i++) {
+    float width = textEditorCharWidth(state, chars[i]);
+    // The character can still not fit on the row after a break at the last space, then it breaks again before it
+    while (x + width > state->wrapWidth && i > rowStart) {
+      int32_t next = lastSpace >= rowStart ? lastSpace + 1 : i;
+      if (breaks && rows - 1 < maxBreaks) breaks[rows - 1] = next;
+      rows++;
+      rowStart = next;
+      x = 0;
+      for (int32_t j = rowStart; j < i; j++) x += textEditorCharWidth(state, chars[j]);
+    }
+    if (chars[i] == ' ' || chars[i] == '\t') lastSpace = i;
+    x += width;
+  }
+  return rows;
+}
+
+// Breaks for a wrap go in scratch that grows to the most rows wrapped at once, so a minified file's single line
+// doesn't get cut short
+static int32_t *wrapScratch = NULL;
+static int32_t wrapScratchCapacity = 0;
+
+static int32_t textEditorWrapBreaks(TextEditorState *state, const char *chars, int32_t length, int32_t **breaks) {
+  int32_t rows = textEditorWrap(state, chars, length, wrapScratch, wrapScratchCapacity);
+  if (rows - 1 > wrapScratchCapacity) {
+    wrapScratchCapacity = CLAY__MAX(rows - 1, wrapScratchCapacity * 2);
+    wrapScratch = (int32_t *)realloc(wrapScratch, sizeof(int32_t) * wrapScratchCapacity);
+    textEditorWrap(state, chars, length, wrapScratch, wrapScratchCapacity);
+  }
+  *breaks = wrapScratch;
+  return rows;
+}
+
+// Row of a line with `rows` rows and these breaks that holds `offset` in it
+static int32_t textEditorRowAt(int32_t *breaks, int32_t rows, int32_t offset) {
+  int32_t low = 0;
+  int32_t high = rows - 1;
+  while (low < high) {
+    int32_t middle = (low + high + 1) / 2;
+    if (breaks[middle - 1] <= offset) low = middle;
+    else high = middle - 1;
+  }
+  return low;
+}
+
+static void textEditorSetRows(TextEditorState *state, int32_t slot, int32_t rows) {
+  if (rows == 1) {
+    free(state->lineBreaks[slot]);
+    state->lineBreaks[slot] = NULL;
+  }
+  fenwickAdd(state->rowTree, state->lineCapacity, slot, rows - state->lineRows[slot]);
+  state->lineRows[slot] = rows;
+  state->lineWrapped[slot] = state->wrapGeneration;
+}
+
+static void textEditorSetBreaks(TextEditorState *state, int32_t line, int32_t *breaks, int32_t rows) {
+  int32_t slot = textEditorSlot(state, line);
+  if (rows > 1) {
+    state->lineBreaks[slot] = (int32_t *)realloc(state->lineBreaks[slot], sizeof(int32_t) * (rows - 1));
+    memcpy(state->lineBreaks[slot], breaks, sizeof(int32_t) * (rows - 1));
+  }
+  textEditorSetRows(state, slot, rows);
+}
+
+static void textEditorRewrap(TextEditorState *state, int32_t line) {
+  int32_t length;
+  char *chars = textEditorLine(state, line, &length);
+  int32_t *breaks;
+  int32_t rows = textEditorWrapBreaks(state, chars, length, &breaks);
+  textEditorSetBreaks(state, line, breaks, rows);
+}
+
+// Breaks being put together by `textEditorRewrapEdit`
+static int32_t *rewrapScratch = NULL;
+static int32_t rewrapScratchCount = 0;
+static int32_t rewrapScratchCapacity = 0;
+
+static void rewrapScratchPush(int32_t value) {
+  if (rewrapScratchCount == rewrapScratchCapacity) {
+    rewrapScratchCapacity = CLAY__MAX(256, rewrapScratchCapacity * 2);
+    rewrapScratch = (int32_t *)realloc(rewrapScratch, sizeof(int32_t) * rewrapScratchCapacity);
+  }
+  rewrapScratch[rewrapScratchCount++] = value;
+}
+
+/* Re-wraps `line` after `deleteLength` bytes at `offset` in it were replaced by `insertLength` without adding or
+   removing line breaks. A greedy row only depends on the text from its start up to the character that didn't fit,
+   which is at most where the row two after it starts, so wrapping restarts two rows before the edit. It goes on in
+   windows of text copied out of the pieces until a row past the edit starts where an old one did, from there the old
+   breaks only shift by the size change. That is usually within a few rows, but in text where every word has the same
+   length a moved word moves all the ones after it
+*/
+static void textEditorRewrapEdit(TextEditorState *state, int32_t line, int32_t offset, int32_t deleteLength, int32_t insertLength) {
+  int32_t slot = textEditorSlot(state, line);
+  if (state->lineWrapped[slot] != state->wrapGeneration || state->wrapWidth <= 0) {
+    textEditorRewrap(state, line);
+    return;
+  }
+
+  int32_t *old = state->lineBreaks[slot];
+  int32_t oldBreaks = state->lineRows[slot] - 1;
+  int32_t delta = insertLength - deleteLength;
+  int32_t editEnd = offset + insertLength;
+  int32_t lineStart = textEditorLineStart(state, line);
+  int32_t length = textEditorLineEnd(state, line) - lineStart;
+
+  int32_t restart = CLAY__MAX(0, textEditorRowAt(old, oldBreaks + 1, offset) - 2);
+  rewrapScratchCount = 0;
+
+  int32_t rowStart = restart > 0 ? old[restart - 1] : 0;
+  int32_t window = 4096;
+  int32_t next = restart; // First old break that can still line up
+  int32_t match = -1;
+  while (match < 0) {
+    int32_t windowEnd = (int32_t)CLAY__MIN((int64_t)length, (int64_t)rowStart + window);
+    char *chars = textEditorText(state, lineStart + rowStart, windowEnd - rowStart);
+    int32_t *breaks;
+    int32_t rows = textEditorWrapBreaks(state, chars, windowEnd - rowStart, &breaks);
+
+    // Breaks inside the window are final, only its last row can still grow
+    for (int32_t i = 0; i < rows - 1 && match < 0; i++) {
+      int32_t at = rowStart + breaks[i];
+      if (at >= editEnd) {
+        while (next < oldBreaks && old[next] < at - delta) next++;
+        if (next < oldBreaks && old[next] == at - delta) {
+          match = next;
+          break;
+        }
+      }
+      rewrapScratchPush(at);
+    }
+    if (match >= 0 || windowEnd == length) break;
+    if (rows > 1) rowStart += breaks[rows - 2];
+    else window *= 2;
+  }
+
+  // The new breaks replace the old ones from the restart up to where they line up, the ones after that shift
+  int32_t tail = match >= 0 ? oldBreaks - match : 0;
+  int32_t count = restart + rewrapScratchCount + tail;
+  if (count > oldBreaks) old = state->lineBreaks[slot] = (int32_t *)realloc(old, sizeof(int32_t) * count);
+  if (tail > 0) memmove(&old[restart + rewrapScratchCount], &old[match], sizeof(int32_t) * tail);
+  for (int32_t i = count - tail; i < count; i++) old[i] += delta;
+  if (rewrapScratchCount > 0) memcpy(&old[restart], rewrapScratch, sizeof(int32_t) * rewrapScratchCount);
+  textEditorSetRows(state, slot, count + 1);
+}
+
+// Grows the gap to fit `count` lines, moving the lines after it to the new end
+static void textEditorReserveLines(TextEditorState *state, int32_t count) {
+  if (count <= state->lineCapacity) return;
+  int32_t after = state->lineCapacity - state->lineGapEnd;
+  int32_t capacity = state->lineCapacity ? state->lineCapacity : 1024;
+  while (capacity < count) capacity *= 2;
+  state->lineStarts = (int32_t *)realloc(state->lineStarts, sizeof(int32_t) * capacity);
+  state->lineRows = (int32_t *)realloc(state->lineRows, sizeof(int32_t) * capacity);
+  state->lineBreaks = (int32_t **)realloc(state->lineBreaks, sizeof(int32_t *) * capacity);
+  state->lineWrapped = (uint32_t *)realloc(state->lineWrapped, sizeof(uint32_t) * capacity);
+  state->rowTree = (int32_t *)realloc(state->rowTree, sizeof(int32_t) * (capacity + 1));
+  memmove(&state->lineStarts[capacity - after], &state->lineStarts[state->lineGapEnd], sizeof(int32_t) * after);
+  memmove(&state->lineRows[capacity - after], &state->lineRows[state->lineGapEnd], sizeof(int32_t) * after);
+  memmove(&state->lineBreaks[capacity - after], &state->lineBreaks[state->lineGapEnd], sizeof(int32_t *) * after);
+  memmove(&state->lineWrapped[capacity - after], &state->lineWrapped[state->lineGapEnd], sizeof(uint32_t) * after);
+  state->lineCapacity = capacity;
+  state->lineGapEnd = capacity - after;
+  memset(&state->lineRows[state->lineGapStart], 0, sizeof(int32_t) * (state->lineGapEnd - state->lineGapStart));
+  fenwickBuild(state->rowTree, state->lineRows, capacity);
+}
+
+// Moves the gap to just before `line`, flipping the starts of the lines it passes between offsets and distances from
+// the end. Edits stay near each other so this is usually a few lines, the tree is rebuilt instead for long moves
+static void textEditorMoveLineGap(TextEditorState *state, int32_t line) {
+  int32_t gap = state->lineGapEnd - state->lineGapStart;
+  int32_t count = line < state->lineGapStart ? state->lineGapStart - line : line - state->lineGapStart;
+  if (count == 0) return;
+  int32_t from = line < state->lineGapStart ? line : state->lineGapEnd;
+  int32_t to = line < state->lineGapStart ? line + gap : state->lineGapStart;
+
+  bool rebuild = (int64_t)count * 32 > state->lineCapacity;
+  if (!rebuild) {
+    for (int32_t i = from; i < from + count; i++) fenwickAdd(state->rowTree, state->lineCapacity, i, -state->lineRows[i]);
+  }
+  memmove(&state->lineStarts[to], &state->lineStarts[from], sizeof(int32_t) * count);
+  memmove(&state->lineRows[to], &state->lineRows[from], sizeof(int32_t) * count);
+  memmove(&state->lineBreaks[to], &state->lineBreaks[from], sizeof(int32_t *) * count);
+  memmove(&state->lineWrapped[to], &state->lineWrapped[from], sizeof(uint32_t) * count);
+  for (int32_t i = to; i < to + count; i++) state->lineStarts[i] = state->length - state->lineStarts[i];
+  // Slots the lines left that they didn't move onto are gap now
+  int32_t vacatedStart = to > from ? from : CLAY__MAX(from, to + count);
+  int32_t vacatedEnd = to > from ? CLAY__MIN(from + count, to) : from + count;
+  if (vacatedEnd > vacatedStart) memset(&state->lineRows[vacatedStart], 0, sizeof(int32_t) * (vacatedEnd - vacatedStart));
+  state->lineGapStart = line;
+  state->lineGapEnd = line + gap;
+
+  if (rebuild) {
+    fenwickBuild(state->rowTree, state->lineRows, state->lineCapacity);
+  } else {
+    for (int32_t i = to; i < to + count; i++) fenwickAdd(state->rowTree, state->lineCapacity, i, state->lineRows[i]);
+  }
+}
+
+// Puts a line starting at `start` into the gap, as the line before the gap
+static void textEditorInsertLine(TextEditorState *state, int32_t start) {
+  textEditorReserveLines(state, state->lineCount + 1);
+  int32_t slot = state->lineGapStart++;
+  state->lineStarts[slot] = start;
+  state->lineRows[slot] = 0;
+  state->lineBreaks[slot] = NULL;
+  state->lineWrapped[slot] = 0;
+  state->lineCount++;
+}
+
+void TextEditorInit(TextEditorState *state, Clay_String text, uint16_t fontId, uint16_t fontSize) {
+  *state = (TextEditorState){.fontId = fontId, .fontSize = fontSize, .lineHeight = fontSize + 2, .wrapGeneration = 1, .textColor = {235, 235, 235, 255}};
+  state->original = (char *)malloc(CLAY__MAX(1, text.length));
+  memcpy(state->original, text.chars, text.length);
+  state->length = text.length;
+  textEditorReservePieces(state, 1);
+  if (text.length > 0) {
+    state->pieces[state->pieceGapStart++] = (TextPiece){.start = 0, .length = text.length};
+    state->pieceCount++;
+    textEditorBuildPieceTree(state);
+  }
+
+  textEditorInsertLine(state, 0);
+  for (const char *newline = text.chars; (newline = (const char *)memchr(newline, '\n', text.chars + text.length - newline)) != NULL; newline++) {
+    textEditorInsertLine(state, (int32_t)(newline - text.chars) + 1);
+  }
+
+  // Unwrapped until the width is known, one row each
+  for (int32_t i = 0; i < state->lineCount; i++) state->lineRows[i] = 1;
+  fenwickBuild(state->rowTree, state->lineRows, state->lineCapacity);
+}
+
+void TextEditorFree(TextEditorState *state) {
+  for (int32_t line = 0; line < state->lineCount; line++) free(state->lineBreaks[textEditorSlot(state, line)]);
+  free(state->original);
+  free(state->added);
+  free(state->pieces);
+  free(state->pieceTree);
+  free(state->lineStarts);
+  free(state->lineRows);
+  free(state->lineBreaks);
+  free(state->lineWrapped);
+  free(state->rowTree);
+  free(state->scratch);
+  *state = (TextEditorState){0};
+}
+
+static void textEditorReplacePieces(TextEditorState *state, int32_t offset, int32_t deleteLength, const char *chars, int32_t insertLength) {
+  // Deleting drops or trims the pieces after the gap, inserting goes into the gap
+  textEditorPieceGapAt(state, offset);
+  for (int32_t remaining = deleteLength; remaining > 0;) {
+    TextPiece *piece = &state->pieces[state->pieceGapEnd];
+    int32_t count = CLAY__MIN(piece->length, remaining);
+    fenwickAdd(state->pieceTree, state->pieceCapacity, state->pieceGapEnd, -count);
+    remaining -= count;
+    if (count == piece->length) {
+      state->pieceGapEnd++;
+      state->pieceCount--;
+    } else {
+      piece->start += count;
+      piece->length -= count;
+    }
+  }
+
+  if (insertLength > 0) {
+    if (state->addedLength + insertLength > state->addedCapacity) {
+      state->addedCapacity = CLAY__MAX(state->addedLength + insertLength, state->addedCapacity ? state->addedCapacity * 2 : 4096);
+      state->added = (char *)realloc(state->added, state->addedCapacity);
+    }
+    memcpy(state->added + state->addedLength, chars, insertLength);
+
+    // Typing continues the piece it appended to last time
+    TextPiece *previous = state->pieceGapStart > 0 ? &state->pieces[state->pieceGapStart - 1] : NULL;
+    if (previous && previous->added && previous->start + previous->length == state->addedLength) {
+      previous->length += insertLength;
+      fenwickAdd(state->pieceTree, state->pieceCapacity, state->pieceGapStart - 1, insertLength);
+    } else {
+      textEditorReservePieces(state, state->pieceCount + 1);
+      state->pieces[state->pieceGapStart] = (TextPiece){.added = true, .start = state->addedLength, .length = insertLength};
+      fenwickAdd(state->pieceTree, state->pieceCapacity, state->pieceGapStart++, insertLength);
+      state->pieceCount++;
+    }
+  }
+  state->addedLength += insertLength;
+  state->length += insertLength - deleteLength;
+}
+
+void TextEditorReplace(TextEditorState *state, int32_t offset, int32_t deleteLength, const char *chars, int32_t insertLength) {
+  assert(offset >= 0 && deleteLength >= 0 && offset + deleteLength <= state->length && "TextEditorReplace out of range");
+
+  // The gap goes right after the edited line, lines starting inside the deleted range are dropped from its end and
+  // one per inserted line break is added at its start. Lines past the edit are relative to the end so stay put
+  int32_t line = textEditorLineAt(state, offset);
+  int32_t lineOffset = offset - textEditorLineStart(state, line);
+  textEditorMoveLineGap(state, line + 1);
+  int32_t removed = 0;
+  while (state->lineGapEnd < state->lineCapacity && state->length - state->lineStarts[state->lineGapEnd] <= offset + deleteLength) {
+    fenwickAdd(state->rowTree, state->lineCapacity, state->lineGapEnd, -state->lineRows[state->lineGapEnd]);
+    free(state->lineBreaks[state->lineGapEnd]);
+    state->lineRows[state->lineGapEnd++] = 0;
+    state->lineCount--;
+    removed++;
+  }
+
+  textEditorReplacePieces(state, offset, deleteLength, chars, insertLength);
+  int32_t added = 0;
+  for (int32_t i = 0; i < insertLength; i++) {
+    if (chars[i] != '\n') continue;
+    textEditorInsertLine(state, offset + i + 1);
+    added++;
+  }
+
+  // Edits that keep the line breaks only re-wrap around the edit, the rest wrap the lines they touched
+  if (added == 0 && removed == 0) {
+    textEditorRewrapEdit(state, line, lineOffset, deleteLength, insertLength);
+  } else {
+    for (int32_t i = line; i <= line + added; i++) textEditorRewrap(state, i);
+  }
+}
+
+// Row within `line` that holds `offset`, and the offset that row starts at
+static int32_t textEditorRowOf(TextEditorState *state, int32_t line, int32_t offset, int32_t *rowStart) {
+  int32_t slot = textEditorSlot(state, line);
+  int32_t *breaks = state->lineBreaks[slot];
+  int32_t lineStart = textEditorLineStart(state, line);
+  int32_t row = textEditorRowAt(breaks, state->lineRows[slot], offset - lineStart);
+  *rowStart = lineStart + (row > 0 ? breaks[row - 1] : 0);
+  return row;
+}
+
+static void textEditorDrawRow(TextEditorState *state, Font font, const char *chars, int32_t length, float x, float y) {
+  // Runs between tabs, with control characters drawn as spaces
+  int32_t runStart = 0;
+  for (int32_t i = 0; i <= length; i++) {
+    if (i < length && chars[i] >= 32 && chars[i] != 127) continue;
+    if (i > runStart) {
+      char *terminated = terminateText((Clay_StringSlice){.length = i - runStart, .chars = chars + runStart});
+      DrawTextEx(font, terminated, (Vector2){x, y}, (float)state->fontSize, 0, CLAY_COLOR_TO_RAYLIB_COLOR(state->textColor));
+      countText(font, chars + runStart, i - runStart);
+      for (int32_t j = runStart; j < i; j++) x += textEditorCharWidth(state, chars[j]);
+    }
+    if (i < length) x += textEditorCharWidth(state, chars[i]);
+    runStart = i + 1;
+  }
+}
+
+static void textEditorDraw(TextEditorState *state, Font *fonts, Clay_BoundingBox box, Clay_BoundingBox clip) {
+  state->viewWidth = box.width;
+  Font font = fonts[state->fontId];
+  int32_t firstRow = CLAY__MAX(0, (int32_t)((clip.y - box.y) / state->lineHeight));
+  int32_t line = textEditorLineAtRow(state, firstRow);
+  int32_t lineRow = textEditorLineRow(state, line);
+  float y = box.y + lineRow * state->lineHeight;
+  // A long wrapped line can start far above the clip, its rows up to there are skipped without copying them
+  int32_t skip = CLAY__MAX(0, firstRow - lineRow);
+
+  for (; line < state->lineCount && y < clip.y + clip.height; line++, skip = 0) {
+    int32_t slot = textEditorSlot(state, line);
+    int32_t rows = state->lineRows[slot];
+    int32_t *breaks = state->lineBreaks[slot];
+    int32_t lineStart = textEditorLineStart(state, line);
+    int32_t length = textEditorLineEnd(state, line) - lineStart;
+    int32_t caretOffset = state->focused && state->caret >= lineStart && state->caret <= lineStart + length ? state->caret - lineStart : -1;
+
+    skip = CLAY__MIN(skip, rows - 1);
+    y += skip * state->lineHeight;
+    for (int32_t row = skip; row < rows && y < clip.y + clip.height; row++, y += state->lineHeight) {
+      int32_t start = row > 0 ? breaks[row - 1] : 0;
+      int32_t end = row + 1 < rows ? breaks[row] : length;
+      char *chars = textEditorText(state, lineStart + start, end - start);
+      if (y + state->lineHeight >= clip.y) textEditorDrawRow(state, font, chars, end - start, box.x, y);
+
+      bool caretInRow = caretOffset >= start && (caretOffset < end || row + 1 == rows);
+      if (caretInRow) {
+        float caretX = box.x;
+        for (int32_t i = 0; i < caretOffset - start; i++) caretX += textEditorCharWidth(state, chars[i]);
+        DrawRectangleRec((Rectangle){caretX, y, 1, state->lineHeight}, CLAY_COLOR_TO_RAYLIB_COLOR(state->textColor));
+        countShapes(1);
+      }
+    }
+  }
+}
+
+/* Canvas */
+CanvasBatch *CanvasBatchAlloc(CanvasMode mode, int32_t vertexCapacity, int32_t indexCapacity) {
+  CanvasBatch *batch = (CanvasBatch *)ArenaAlloc(&renderer.frameArena, sizeof(CanvasBatch));
+  *batch = (CanvasBatch){
+      .mode = mode,
+      .pointSize = 2,
+      .vertices = (CanvasVertex *)ArenaAlloc(&renderer.frameArena, sizeof(CanvasVertex) * vertexCapacity),
+      .vertexCapacity = vertexCapacity,
+      .indices = indexCapacity ? (uint32_t *)ArenaAlloc(&renderer.frameArena, sizeof(uint32_t) * indexCapacity) : NULL,
+      .indexCapacity = indexCapacity,
+  };
+  return batch;
+}
+
+uint32_t CanvasVertices(CanvasBatch *batch, CanvasVertex *vertices, int32_t count) {
+  assert(batch->vertexCount + count <= batch->vertexCapacity && "Canvas batch ran out of vertices");
+  memcpy(batch->vertices + batch->vertexCount, vertices, sizeof(CanvasVertex) * count);
+  batch->vertexCount += count;
+  return (uint32_t)(batch->vertexCount - count);
+}
+
+void CanvasIndices(CanvasBatch *batch, uint32_t *indices, int32_t count) {
+  assert(batch->indexCount + count <= batch->indexCapacity && "Canvas batch ran out of indices");
+  memcpy(batch->indices + batch->indexCount, indices, sizeof(uint32_t) * count);
+  batch->indexCount += count;
+}
+
+void CanvasLine(CanvasBatch *batch, float x0, float y0, float x1, float y1, Color color) {
+  CanvasVertices(batch, (CanvasVertex[]){{x0, y0, color}, {x1, y1, color}}, 2);
+}
+
+void CanvasTriangle(CanvasBatch *batch, Vector2 a, Vector2 b, Vector2 c, Color color) {
+  CanvasVertices(batch, (CanvasVertex[]){{a.x, a.y, color}, {b.x, b.y, color}, {c.x, c.y, color}}, 3);
+}
+
+void CanvasPoint(CanvasBatch *batch, float x, float y, Color color) {
+  CanvasVertices(batch, (CanvasVertex[]){{x, y, color}}, 1);
+}
+
+static void canvasVertex(CanvasVertex vertex, float x, float y) {
+  rlColor4ub(vertex.color.r, vertex.color.g, vertex.color.b, vertex.color.a);
+  rlVertex2f(x + vertex.x, y + vertex.y);
+}
+
+static void canvasDraw(CanvasBatch *batch, Clay_Color background, Clay_BoundingBox box, Clay_BoundingBox clip, Clay_BoundingBox screen) {
+  // Clay gives custom elements their background instead of a rectangle command
+  if (background.a > 0) {
+    DrawRectangleRec((Rectangle){box.x, box.y, box.width, box.height}, CLAY_COLOR_TO_RAYLIB_COLOR(background));
+    countShapes(1);
+  }
+  int32_t count = !batch ? 0 : batch->indices ? batch->indexCount : batch->vertexCount;
+  if (count == 0) return;
+
+  beginClip(box, clip);
+  int32_t perPrimitive = batch->mode == CANVAS_LINES ? 2 : batch->mode == CANVAS_TRIANGLES ? 3 : 1;
+  int32_t mode = batch->mode == CANVAS_LINES ? RL_LINES : batch->mode == CANVAS_TRIANGLES ? RL_TRIANGLES : RL_QUADS;
+  countDraw(mode, rlGetTextureIdDefault(), count / perPrimitive * (batch->mode == CANVAS_POINTS ? 4 : perPrimitive));
+  rlBegin(mode);
+  for (int32_t i = 0; i + perPrimitive <= count; i += perPrimitive) {
+    // A primitive never gets split by a flush
+    rlCheckRenderBatchLimit(4);
+    if (batch->mode == CANVAS_POINTS) {
+      CanvasVertex point = batch->vertices[batch->indices ? batch->indices[i] : (uint32_t)i];
+      float half = batch->pointSize / 2;
+      canvasVertex(point, box.x - half, box.y - half);
+      canvasVertex(point, box.x - half, box.y + half);
+      canvasVertex(point, box.x + half, box.y + half);
+      canvasVertex(point, box.x + half, box.y - half);
+      continue;
+    }
+    for (int32_t j = i; j < i + perPrimitive; j++) {
+      canvasVertex(batch->vertices[batch->indices ? batch->indices[j] : (uint32_t)j], box.x, box.y);
+    }
+  }
+  rlEnd();
+  endClip(clip, screen);
+}
+
+/* Dynamic texture */
+void DynamicTextureInit(DynamicTexture *texture, int32_t width, int32_t height) {
+  *texture = (DynamicTexture){.width = width, .height = height};
+  texture->pixels = (Color *)calloc(width * height, sizeof(Color));
+  texture->staging = (Color *)malloc(sizeof(Color) * width * height);
+  Image image = GenImageColor(width, height, BLANK);
+  texture->texture = LoadTextureFromImage(image);
+  UnloadImage(image);
+}
+
+void DynamicTextureFree(DynamicTexture *texture) {
+  if (texture->texture.id) UnloadTexture(texture->texture);
+  free(texture->pixels);
+  free(texture->staging);
+  *texture = (DynamicTexture){0};
+}
+
+static Rectangle rectangleUnion(Rectangle a, Rectangle b) {
+  float left = fminf(a.x, b.x);
+  float top = fminf(a.y, b.y);
+  return (Rectangle){left, top, fmaxf(a.x + a.width, b.x + b.width) - left, fmaxf(a.y + a.height, b.y + b.height) - top};
+}
+
+static bool rectangleTouches(Rectangle a, Rectangle b) {
+  return a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+void DynamicTextureMarkDirty(DynamicTexture *texture, int32_t x, int32_t y, int32_t width, int32_t height) {
+  int32_t left = CLAY__MAX(0, x);
+  int32_t top = CLAY__MAX(0, y);
+  int32_t right = CLAY__MIN(texture->width, x + width);
+  int32_t bottom = CLAY__MIN(texture->height, y + height);
+  if (right <= left || bottom <= top) return;
+  Rectangle rect = {(float)left, (float)top, (float)(right - left), (float)(bottom - top)};
+
+  // Swallow every rect it touches, the union can touch new ones so go again until it doesn't grow
+  for (int32_t i = 0; i < texture->dirtyCount;) {
+    if (rectangleTouches(rect, texture->dirty[i])) {
+      rect = rectangleUnion(rect, texture->dirty[i]);
+      texture->dirty[i] = texture->dirty[--texture->dirtyCount];
+      i = 0;
+    } else {
+      i++;
+    }
+  }
+
+  if (texture->dirtyCount == DYNAMIC_TEXTURE_MAX_DIRTY) {
+    // Full, merge with the rect whose union grows the least
+    int32_t best = 0;
+    float bestGrowth = INFINITY;
+    for (int32_t i = 0; i < texture->dirtyCount; i++) {
+      Rectangle merged = rectangleUnion(rect, texture->dirty[i]);
+      float growth = merged.width * merged.height - texture->dirty[i].width * texture->dirty[i].height;
+      if (growth < bestGrowth) {
+        bestGrowth = growth;
+        best = i;
+      }
+    }
+    rect = rectangleUnion(rect, texture->dirty[best]);
+    texture->dirty[best] = texture->dirty[--texture->dirtyCount];
+    DynamicTextureMarkDirty(texture, (int32_t)rect.x, (int32_t)rect.y, (int32_t)rect.width, (int32_t)rect.height);
+    return;
+  }
+  texture->dirty[texture->dirtyCount++] = rect;
+}
+
+static void dynamicTextureUpload(DynamicTexture *texture) {
+  if (texture->dirtyCount == 0) return;
+
+  // Past half the texture one contiguous upload beats packing the rects
+  float dirtyArea = 0;
+  for (int32_t i = 0; i < texture->dirtyCount; i++) dirtyArea += texture->dirty[i].width * texture->dirty[i].height;
+  if (dirtyArea * 2 > (float)texture->width * texture->height) {
+    UpdateTexture(texture->texture, texture->pixels);
+    texture->dirtyCount = 0;
+    return;
+  }
+
+  Color *staging = texture->staging;
+  for (int32_t i = 0; i < texture->dirtyCount; i++) {
+    Rectangle rect = texture->dirty[i];
+    int32_t width = (int32_t)rect.width;
+    for (int32_t row = 0; row < (int32_t)rect.height; row++) {
+      memcpy(staging + row * width, texture->pixels + ((int32_t)rect.y + row) * texture->width + (int32_t)rect.x, sizeof(Color) * width);
+    }
+    UpdateTextureRec(texture->texture, rect, staging);
+    staging += width * (int32_t)rect.height;
+  }
+  texture->dirtyCount = 0;
+}
+
+static void dynamicTextureDraw(DynamicTexture *texture, Clay_Color background, Clay_BoundingBox box) {
+  if (background.a > 0) {
+    DrawRectangleRec((Rectangle){box.x, box.y, box.width, box.height}, CLAY_COLOR_TO_RAYLIB_COLOR(background));
+    countShapes(1);
+  }
+  dynamicTextureUpload(texture);
+  Rectangle source = {0, 0, (float)texture->width, (float)texture->height};
+  DrawTexturePro(texture->texture, source, (Rectangle){box.x, box.y, box.width, box.height}, (Vector2){0, 0}, 0, WHITE);
+  countDraw(RL_QUADS, texture->texture.id, 4);
+}
+
+static void sparklineVertex(CustomLayoutElement_Sparkline *line, float x, float value) {
+  Clay_BoundingBox box = line->box;
+  float t = (value - line->min) / (line->max - line->min);
+  rlVertex2f(box.x + x, box.y + box.height - 1 - CLAY__MAX(0.0f, CLAY__MIN(1.0f, t)) * (box.height - 1));
+}
+
+static bool boxesOverlap(Clay_BoundingBox a, Clay_BoundingBox b) {
+  return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// Whether `box` would be drawn over a queued sparkline, `bounds` covers all of them so most commands stop there
+static bool sparklinesUnder(CustomLayoutElement_Sparkline *queue, Clay_BoundingBox bounds, Clay_BoundingBox box) {
+  if (!queue || !boxesOverlap(bounds, box)) return false;
+  for (CustomLayoutElement_Sparkline *line = queue; line; line = line->next) {
+    if (boxesOverlap(line->box, box)) return true;
+  }
+  return false;
+}
+
+// Draws every queued sparkline in one `RL_LINES` batch under the current scissor and empties the queue
+static void sparklinesFlush(CustomLayoutElement_Sparkline **queue) {
+  if (!*queue) return;
+  rlBegin(RL_LINES);
+  for (CustomLayoutElement_Sparkline *line = *queue; line; line = line->next) {
+    rlColor4ub((uint8_t)line->color.r, (uint8_t)line->color.g, (uint8_t)line->color.b, (uint8_t)line->color.a);
+    int32_t columns = (int32_t)line->box.width;
+    countDraw(RL_LINES, rlGetTextureIdDefault(), line->count > columns ? 4 * columns - 2 : 2 * (line->count - 1));
+    if (line->count > columns) {
+      // Each column's envelope, joined to the next column so there are no gaps
+      float lastMax = 0;
+      for (int32_t column = 0; column < columns; column++) {
+        int64_t start = (int64_t)line->count * column / columns;
+        int64_t end = (int64_t)line->count * (column + 1) / columns;
+        float min, max;
+        DecimateMinMax(line->values + start, end - start, 1, &min, &max);
+        rlCheckRenderBatchLimit(4);
+        if (column > 0) {
+          sparklineVertex(line, column - 0.5f, lastMax);
+          sparklineVertex(line, column + 0.5f, min);
+        }
+        sparklineVertex(line, column + 0.5f, min);
+        sparklineVertex(line, column + 0.5f, max);
+        lastMax = max;
+      }
+    } else {
+      float step = line->count > 1 ? (line->box.width - 1) / (line->count - 1) : 0;
+      for (int32_t i = 0; i + 1 < line->count; i++) {
+        rlCheckRenderBatchLimit(2);
+        sparklineVertex(line, 0.5f + i * step, line->values[i]);
+        sparklineVertex(line, 0.5f + (i + 1) * step, line->values[i + 1]);
+      }
+    }
+  }
+  rlEnd();
+  *queue = NULL;
+}
+
+static void flameGraphDraw(CustomLayoutElement_FlameGraph *graph, Font *fonts, Clay_Color background, Clay_BoundingBox box, Clay_BoundingBox clip, Clay_BoundingBox screen) {
+  canvasDraw(graph->blocks, background, box, clip, screen);
+  if (graph->labelCount == 0) return;
+  beginClip(box, clip);
+  for (int32_t i = 0; i < graph->labelCount; i++) {
+    FlameLabel label = graph->labels[i];
+    if (box.y + label.y > clip.y + clip.height || box.y + label.y + graph->fontSize < clip.y) continue;
+    drawTextLine(fonts[graph->fontId], label.text.chars, label.text.length, (Vector2){box.x + label.x, box.y + label.y}, graph->fontSize, CLAY_COLOR_TO_RAYLIB_COLOR(graph->textColor));
+  }
+  endClip(clip, screen);
+}
+
+static void preTextDraw(CustomLayoutElement_PreText *text, Font *fonts, Clay_BoundingBox box, Clay_BoundingBox clip) {
+  float top = fmaxf(box.y, clip.y);
+  float bottom = fminf(box.y + box.height, clip.y + clip.height);
+  int32_t first = CLAY__MAX(0, (int32_t)((top - box.y) / text->lineHeight));
+  int32_t last = CLAY__MIN(text->lineCount, (int32_t)ceilf((bottom - box.y) / text->lineHeight));
+
+  for (int32_t line = first; line < last; line++) {
+    Clay_String string = text->lines[line];
+    if (string.length == 0) continue;
+    Vector2 position = {box.x, box.y + line * text->lineHeight};
+    drawTextLine(fonts[text->fontId], string.chars, string.length, position, (float)text->fontSize, CLAY_COLOR_TO_RAYLIB_COLOR(text->color));
+  }
+}
+
+void Clay_Raylib_Render(Clay_RenderCommandArray renderCommands, Font *fonts) {
+  double renderStart = GetTime();
+  // Custom elements that draw only what's visible clip against this
+  Clay_BoundingBox screen = {0, 0, (float)GetScreenWidth(), (float)GetScreenHeight()};
+  Clay_BoundingBox clip = screen;
+  CustomLayoutElement_Sparkline *sparklines = NULL;
+  Clay_BoundingBox sparklineBounds = {0};
+#ifdef RENDERER_ATTRIBUTION
+  // Commands of one entry come in runs, so time is taken when the entry changes instead of around every command
+  AttributionEntry *timedEntry = NULL;
+  double timedStart = renderStart;
+#endif
+  for (int j = 0; j < renderCommands.length; j++) {
+    Clay_RenderCommand *renderCommand = Clay_RenderCommandArray_Get(&renderCommands, j);
+    Clay_BoundingBox boundingBox = renderCommand->boundingBox;
+    RENDERER_PROBE2(render_command, renderCommand->commandType, j);
+#ifdef RENDERER_ATTRIBUTION
+    AttributionEntry *commandEntry = attributionCommandEntry(renderCommand);
+    if (commandEntry != timedEntry) {
+      double now = GetTime();
+      if (timedEntry) timedEntry->renderTime += now - timedStart;
+      timedEntry = commandEntry;
+      timedStart = now;
+    }
+    uint32_t commandVertices = renderer.counters.vertices;
+#endif
+    // Queued sparklines go down before anything that would cover them, ex. a tooltip floating over the table
+    if (sparklinesUnder(sparklines, sparklineBounds, boundingBox)) sparklinesFlush(&sparklines);
+    switch (renderCommand->commandType) {
+    case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+      // Raylib uses standard C strings so isn't compatible with cheap slices, we need to copy the string to append null terminator
+      Clay_TextRenderData *textData = &renderCommand->renderData.text;
+      char *terminated = terminateText(textData->stringContents);
+      Font fontToUse = fonts[textData->fontId];
+      DrawTextEx(fontToUse, terminated, (Vector2){boundingBox.x, boundingBox.y}, (float)textData->fontSize, (float)textData->letterSpacing, CLAY_COLOR_TO_RAYLIB_COLOR(textData->textColor));
+      countText(fontToUse, textData->stringContents.chars, textData->stringContents.length);
+      break;
+    }
+    case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
+      Texture2D imageTexture = *(Texture2D *)renderCommand->renderData.image.imageData;
+      Clay_Color tintColor = renderCommand->renderData.image.backgroundColor;
+      if (tintColor.r == 0 && tintColor.g == 0 && tintColor.b == 0 && tintColor.a == 0) {
+        tintColor = (Clay_Color){255, 255, 255, 255};
+      }
+      DrawTextureEx(imageTexture, (Vector2){boundingBox.x, boundingBox.y}, 0, boundingBox.width / (float)imageTexture.width, CLAY_COLOR_TO_RAYLIB_COLOR(tintColor));
+      countDraw(RL_QUADS, imageTexture.id, 4);
+      break;
+    }
+    case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
+      sparklinesFlush(&sparklines);
+      countScissor();
+      clip = boundingBox;
+      BeginScissorMode((int)roundf(boundingBox.x), (int)roundf(boundingBox.y), (int)roundf(boundingBox.width), (int)roundf(boundingBox.height));
+      break;
+    }
+    case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
+      sparklinesFlush(&sparklines);
+      countScissor();
+      clip = screen;
+      EndScissorMode();
+      break;
+    }
+    case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
+      Clay_RectangleRenderData *config = &renderCommand->renderData.rectangle;
+      if (config->cornerRadius.topLeft > 0) {
+        float radius = (config->cornerRadius.topLeft * 2) / (float)((boundingBox.width > boundingBox.height) ? boundingBox.height : boundingBox.width);
+        DrawRectangleRounded((Rectangle){boundingBox.x, boundingBox.y, boundingBox.width, boundingBox.height}, radius, 8, CLAY_COLOR_TO_RAYLIB_COLOR(config->backgroundColor));
+        countShapes(roundedRectangleQuads(8));
+      } else {
+        DrawRectangle(boundingBox.x, boundingBox.y, boundingBox.width, boundingBox.height, CLAY_COLOR_TO_RAYLIB_COLOR(config->backgroundColor));
+        countShapes(1);
+      }
+      break;
+    }
+    case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+      Clay_BorderRenderData *config = &renderCommand->renderData.border;
+      // Left border
+      if (config->width.left > 0) {
+        DrawRectangle((int)roundf(boundingBox.x),
+                      (int)roundf(boundingBox.y + config->cornerRadius.topLeft),
+                      (int)config->width.left,
+                      (int)roundf(boundingBox.height - config->cornerRadius.topLeft - config->cornerRadius.bottomLeft),
+                      CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
+        countShapes(1);
+      }
+      // Right border
+      if (config->width.right > 0) {
+        DrawRectangle((int)roundf(boundingBox.x + boundingBox.width - config->width.right),
+                      (int)roundf(boundingBox.y + config->cornerRadius.topRight),
+                      (int)config->width.right,
+                      (int)roundf(boundingBox.height - config->cornerRadius.topRight - config->cornerRadius.bottomRight),
+                      CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
+        countShapes(1);
+      }
+      // Top border
+      if (config->width.top > 0) {
+        DrawRectangle((int)roundf(boundingBox.x + config->cornerRadius.topLeft),
+                      (int)roundf(boundingBox.y),
+                      (int)roundf(boundingBox.width - config->cornerRadius.topLeft - config->cornerRadius.topRight),
+                      (int)config->width.top,
+                      CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
+        countShapes(1);
+      }
+      // Bottom border
+      if (config->width.bottom > 0) {
+        DrawRectangle((int)roundf(boundingBox.x + config->cornerRadius.bottomLeft),
+                      (int)roundf(boundingBox.y + boundingBox.height - config->width.bottom),
+                      (int)roundf(boundingBox.width - config->cornerRadius.bottomLeft - config->cornerRadius.bottomRight),
+                      (int)config->width.bottom,
+                      CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
+        countShapes(1);
+      }
+      if (config->cornerRadius.topLeft > 0) {
+        DrawRing((Vector2){roundf(boundingBox.x + config->cornerRadius.topLeft), roundf(boundingBox.y + config->cornerRadius.topLeft)},
+                 roundf(config->cornerRadius.topLeft - config->width.top),
+                 config->cornerRadius.topLeft,
+                 180,
+                 270,
+                 10,
+                 CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
+        countShapes(ringQuads(roundf(config->cornerRadius.topLeft - config->width.top), 10));
+      }
+      if (config->cornerRadius.topRight > 0) {
+        DrawRing((Vector2){roundf(boundingBox.x + boundingBox.width - config->cornerRadius.topRight), roundf(boundingBox.y + config->cornerRadius.topRight)},
+                 roundf(config->cornerRadius.topRight - config->width.top),
+                 config->cornerRadius.topRight,
+                 270,
+                 360,
+                 10,
+                 CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
+        countShapes(ringQuads(roundf(config->cornerRadius.topRight - config->width.top), 10));
+      }
+      if (config->cornerRadius.bottomLeft > 0) {
+        DrawRing((Vector2){roundf(boundingBox.x + config->cornerRadius.bottomLeft), roundf(boundingBox.y + boundingBox.height - config->cornerRadius.bottomLeft)},
+                 roundf(config->cornerRadius.bottomLeft - config->width.top),
+                 config->cornerRadius.bottomLeft,
+                 90,
+                 180,
+                 10,
+                 CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
+        countShapes(ringQuads(roundf(config->cornerRadius.bottomLeft - config->width.top), 10));
+      }
+      if (config->cornerRadius.bottomRight > 0) {
+        DrawRing((Vector2){roundf(boundingBox.x + boundingBox.width - config->cornerRadius.bottomRight), roundf(boundingBox.y + boundingBox.height - config->cornerRadius.bottomRight)},
+                 roundf(config->cornerRadius.bottomRight - config->width.bottom),
+                 config->cornerRadius.bottomRight,
+                 0.1,
+                 90,
+                 10,
+                 CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
+        countShapes(ringQuads(roundf(config->cornerRadius.bottomRight - config->width.bottom), 10));
+      }
+      break;
+    }
+    case CLAY_RENDER_COMMAND_TYPE_CUSTOM: {
+      Clay_CustomRenderData *config = &renderCommand->renderData.custom;
+      CustomLayoutElement *customElement = (CustomLayoutElement *)config->customData;
+      if (!customElement) continue;
+      switch (customElement->type) {
+      case CUSTOM_LAYOUT_ELEMENT_TYPE_3D_MODEL: {
+        Clay_BoundingBox rootBox = renderCommands.internalArray[0].boundingBox;
+        float scaleValue = CLAY__MIN(CLAY__MIN(1, 768 / rootBox.height) * CLAY__MAX(1, rootBox.width / 1024), 1.5f);
+        Ray positionRay = GetScreenToWorldPointWithZDistance((Vector2){renderCommand->boundingBox.x + renderCommand->boundingBox.width / 2, renderCommand->boundingBox.y + (renderCommand->boundingBox.height / 2) + 20},
+                                                             Raylib_camera,
+                                                             (int)roundf(rootBox.width),
+                                                             (int)roundf(rootBox.height),
+                                                             140);
+        countFlush();
+        BeginMode3D(Raylib_camera);
+        DrawModel(customElement->customData.model.model, positionRay.position, customElement->customData.model.scale * scaleValue, WHITE); // Draw 3d model with texture
+        countModel(customElement->customData.model.model);
+        EndMode3D();
+        break;
+      }
+      case CUSTOM_LAYOUT_ELEMENT_TYPE_TEXT_SPANS: {
+        CustomLayoutElement_TextSpans *text = &customElement->customData.textSpans;
+        for (int32_t i = 0; i < text->spanCount; i++) {
+          TextSpan span = text->spans[i];
+          float x = text->offsets ? text->offsets[i] : span.start * text->advance;
+          Vector2 position = {boundingBox.x + x, boundingBox.y + text->height - span.fontSize};
+          drawTextLine(fonts[span.fontId], text->chars + span.start, span.length, position, (float)span.fontSize, CLAY_COLOR_TO_RAYLIB_COLOR(span.color));
+        }
+        break;
+      }
+      case CUSTOM_LAYOUT_ELEMENT_TYPE_GLYPH_GRID: {
+        GlyphGridState *state = customElement->customData.glyphGrid;
+        glyphGridDraw(state, fonts[state->fontId], boundingBox.x, boundingBox.y);
+        break;
+      }
+      case CUSTOM_LAYOUT_ELEMENT_TYPE_PRE_TEXT: {
+        preTextDraw(&customElement->customData.preText, fonts, boundingBox, clip);
+        break;
+      }
+      case CUSTOM_LAYOUT_ELEMENT_TYPE_TEXT_INPUT: {
+        textInputDraw(customElement->customData.textInput, fonts, boundingBox, clip, screen);
+        break;
+      }
+      case CUSTOM_LAYOUT_ELEMENT_TYPE_TEXT_EDITOR: {
+        textEditorDraw(customElement->customData.textEditor, fonts, boundingBox, clip);
+        break;
+      }
+      case CUSTOM_LAYOUT_ELEMENT_TYPE_DYNAMIC_TEXTURE: {
+        dynamicTextureDraw(customElement->customData.dynamicTexture, config->backgroundColor, boundingBox);
+        break;
+      }
+      case CUSTOM_LAYOUT_ELEMENT_TYPE_CANVAS: {
+        canvasDraw(customElement->customData.canvas, config->backgroundColor, boundingBox, clip, screen);
+        break;
+      }
+      case CUSTOM_LAYOUT_ELEMENT_TYPE_FLAME_GRAPH: {
+        flameGraphDraw(&customElement->customData.flameGraph, fonts, config->backgroundColor, boundingBox, clip, screen);
+        break;
+      }
+      case CUSTOM_LAYOUT_ELEMENT_TYPE_SPARKLINE: {
+        // The background goes down now, the line waits for the batch
+        if (config->backgroundColor.a > 0) {
+          DrawRectangleRec((Rectangle){boundingBox.x, boundingBox.y, boundingBox.width, boundingBox.height}, CLAY_COLOR_TO_RAYLIB_COLOR(config->backgroundColor));
+          countShapes(1);
+        }
+        CustomLayoutElement_Sparkline *line = &customElement->customData.sparkline;
+        if (!boxesOverlap(boundingBox, clip) || line->count < 2 || boundingBox.width < 1) break;
+        if (!sparklines) {
+          sparklineBounds = boundingBox;
+        } else {
+          float left = fminf(sparklineBounds.x, boundingBox.x);
+          float top = fminf(sparklineBounds.y, boundingBox.y);
+          float right = fmaxf(sparklineBounds.x + sparklineBounds.width, boundingBox.x + boundingBox.width);
+          float bottom = fmaxf(sparklineBounds.y + sparklineBounds.height, boundingBox.y + boundingBox.height);
+          sparklineBounds = (Clay_BoundingBox){left, top, right - left, bottom - top};
+        }
+        line->box = boundingBox;
+        line->next = sparklines;
+        sparklines = line;
+        break;
+      }
+      default:
+        break;
+      }
+      break;
+    }
+    default: {
+      LogError(LOG_CATEGORY_RENDERER, "Unhandled render command %d", renderCommand->commandType);
+      LogFlush();
+      exit(1);
+    }
+    }
+#ifdef RENDERER_ATTRIBUTION
+    attributionRecordCommand(renderCommand, renderer.counters.vertices - commandVertices);
+#endif
+  }
+  sparklinesFlush(&sparklines);
+  double renderEnd = GetTime();
+#ifdef RENDERER_ATTRIBUTION
+  if (timedEntry) timedEntry->renderTime += renderEnd - timedStart;
+#endif
+  HistogramRecord(&renderer.phases[RENDER_PHASE_RENDER], (uint32_t)((renderEnd - renderStart) * 1e6));
+}
+
+Clay_String toClayString(char *str) {
+  return (Clay_String){.length = strlen(str), .chars = str};
+}
+
+/* Threads */
+typedef struct {
+  RenderThreadFunction function;
+  void *arg;
+} RenderThreadStartData;
+
+#ifdef _WIN32
+static DWORD WINAPI renderThreadEntry(LPVOID param) {
+#else
+static void *renderThreadEntry(void *param) {
+#endif
+  RenderThreadStartData data = *(RenderThreadStartData *)param;
+  free(param);
+  data.function(data.arg);
+  return 0;
+}
+
+bool RenderThreadStart(RenderThread *thread, RenderThreadFunction function, void *arg) {
+  RenderThreadStartData *data = (RenderThreadStartData *)malloc(sizeof(RenderThreadStartData));
+  *data = (RenderThreadStartData){.function = function, .arg = arg};
+#ifdef _WIN32
+  *thread = CreateThread(NULL, 0, renderThreadEntry, data, 0, NULL);
+  bool started = *thread != NULL;
+#else
+  bool started = pthread_create(thread, NULL, renderThreadEntry, data) == 0;
+#endif
+  if (!started) free(data);
+  return started;
+}
+
+void RenderThreadJoin(RenderThread thread) {
+#ifdef _WIN32
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+#else
+  pthread_join(thread, NULL);
+#endif
+}
+
+void RenderSleep(double seconds) {
+#ifdef _WIN32
+  Sleep((DWORD)(seconds * 1000));
+#else
+  struct timespec duration = {.tv_sec = (time_t)seconds, .tv_nsec = (long)((seconds - (time_t)seconds) * 1e9)};
+  nanosleep(&duration, NULL);
+#endif
+}
+
+static void renderMutexInit(RenderMutex *mutex) {
+#ifdef _WIN32
+  InitializeCriticalSection(mutex);
+#else
+  pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+static void renderMutexLock(RenderMutex *mutex) {
+#ifdef _WIN32
+  EnterCriticalSection(mutex);
+#else
+  pthread_mutex_lock(mutex);
+#endif
+}
+
+static void renderMutexUnlock(RenderMutex *mutex) {
+#ifdef _WIN32
+  LeaveCriticalSection(mutex);
+#else
+  pthread_mutex_unlock(mutex);
+#endif
+}
+
+static void renderConditionInit(RenderCondition *condition) {
+#ifdef _WIN32
+  InitializeConditionVariable(condition);
+#else
+  pthread_cond_init(condition, NULL);
+#endif
+}
+
+static void renderConditionWait(RenderCondition *condition, RenderMutex *mutex) {
+#ifdef _WIN32
+  SleepConditionVariableCS(condition, mutex, INFINITE);
+#else
+  pthread_cond_wait(condition, mutex);
+#endif
+}
+
+static void renderConditionBroadcast(RenderCondition *condition) {
+#ifdef _WIN32
+  WakeAllConditionVariable(condition);
+#else
+  pthread_cond_broadcast(condition);
+#endif
+}
+
+int32_t RenderCoreCount(void) {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (int32_t)info.dwNumberOfProcessors;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (int32_t)count : 1;
+#endif
+}
+
+/* Worker pool, started on the first `RenderParallelFor`. Each job bumps `generation` to wake the workers, which copy
+   the job under the lock and claim tasks with an atomic counter. The caller waits until no worker is left in the job,
+   so a slow one can never claim a task of the next
+*/
+#define RENDER_POOL_MAX_THREADS 64
+
+static struct {
+  RenderThread threads[RENDER_POOL_MAX_THREADS];
+  int32_t threadCount;
+  RenderMutex mutex;
+  RenderCondition wake;
+  RenderCondition done;
+  uint64_t generation;
+  int32_t active; // Workers inside the current job
+  bool stop;
+
+  RenderTaskFunction function;
+  void *arg;
+  int32_t taskCount;
+  atomic_int nextTask;
+} renderPool;
+
+static void renderPoolRunTasks(RenderTaskFunction function, void *arg, int32_t taskCount) {
+  for (int32_t task = atomic_fetch_add(&renderPool.nextTask, 1); task < taskCount; task = atomic_fetch_add(&renderPool.nextTask, 1)) {
+    function(task, arg);
+  }
+}
+
+static void renderPoolWorker(void *arg) {
+  (void)arg;
+  uint64_t seen = 0;
+  while (true) {
+    renderMutexLock(&renderPool.mutex);
+    while (renderPool.generation == seen && !renderPool.stop) renderConditionWait(&renderPool.wake, &renderPool.mutex);
+    if (renderPool.stop) {
+      renderMutexUnlock(&renderPool.mutex);
+      return;
+    }
+    seen = renderPool.generation;
+    // Joining a job with every task claimed could race the caller resetting the counter for the next one
+    if (atomic_load(&renderPool.nextTask) >= renderPool.taskCount) {
+      renderMutexUnlock(&renderPool.mutex);
+      continue;
+    }
+    renderPool.active++;
+    RenderTaskFunction function = renderPool.function;
+    void *taskArg = renderPool.arg;
+    int32_t taskCount = renderPool.taskCount;
+    renderMutexUnlock(&renderPool.mutex);
+
+    renderPoolRunTasks(function, taskArg, taskCount);
+
+    renderMutexLock(&renderPool.mutex);
+    renderPool.active--;
+    renderConditionBroadcast(&renderPool.done);
+    renderMutexUnlock(&renderPool.mutex);
+  }
+}
+
+void RenderParallelFor(int32_t taskCount, RenderTaskFunction function, void *arg) {
+  if (taskCount <= 0) return;
+  if (renderPool.threadCount == 0) {
+    renderMutexInit(&renderPool.mutex);
+    renderConditionInit(&renderPool.wake);
+    renderConditionInit(&renderPool.done);
+    int32_t workers = CLAY__MIN(RenderCoreCount() - 1, RENDER_POOL_MAX_THREADS);
+    for (int32_t i = 0; i < workers; i++) {
+      if (RenderThreadStart(&renderPool.threads[renderPool.threadCount], renderPoolWorker, NULL)) renderPool.threadCount++;
+    }
+    // Marks the pool as started even without workers, tasks then just run here
+    if (renderPool.threadCount == 0) renderPool.threadCount = -1;
+  }
+
+  renderMutexLock(&renderPool.mutex);
+  renderPool.function = function;
+  renderPool.arg = arg;
+  renderPool.taskCount = taskCount;
+  atomic_store(&renderPool.nextTask, 0);
+  renderPool.generation++;
+  renderConditionBroadcast(&renderPool.wake);
+  renderMutexUnlock(&renderPool.mutex);
+
+  // Once this runs out of tasks every task is claimed, what's left is waiting on the workers still running theirs
+  renderPoolRunTasks(function, arg, taskCount);
+  renderMutexLock(&renderPool.mutex);
+  while (renderPool.active > 0) renderConditionWait(&renderPool.done, &renderPool.mutex);
+  renderMutexUnlock(&renderPool.mutex);
+}
+
+static void renderPoolStop(void) {
+  if (renderPool.threadCount <= 0) return;
+  renderMutexLock(&renderPool.mutex);
+  renderPool.stop = true;
+  renderConditionBroadcast(&renderPool.wake);
+  renderMutexUnlock(&renderPool.mutex);
+  for (int32_t i = 0; i < renderPool.threadCount; i++) RenderThreadJoin(renderPool.threads[i]);
+  renderPool.threadCount = 0;
+  renderPool.stop = false;
+}
+
+/* Logging, bounded MPMC queue inspired from:
+   https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+*/
+typedef struct {
+  atomic_size_t sequence;
+  uint8_t level;
+  uint8_t category;
+  char text[LOG_MESSAGE_SIZE];
+} LogSlot;
+
+static struct {
+  LogSlot slots[LOG_RING_SIZE];
+  atomic_size_t head;
+  size_t tail; // Only touched by the writer thread
+  atomic_size_t written;
+  atomic_uint dropped;
+  atomic_bool running;
+  bool categoryDisabled[LOG_CATEGORY_COUNT];
+  RenderThread thread;
+} logState = {0};
+
+static const char *logLevelNames[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+static const char *logCategoryNames[LOG_CATEGORY_COUNT] = {"renderer", "clay", "scroll", "input", "app"};
+
+static bool logPush(int level, LogCategory category, const char *text) {
+  size_t position = atomic_load_explicit(&logState.head, memory_order_relaxed);
+  LogSlot *slot;
+  for (;;) {
+    slot = &logState.slots[position & (LOG_RING_SIZE - 1)];
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+    if (difference == 0) {
+      if (atomic_compare_exchange_weak_explicit(&logState.head, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) break;
+    } else if (difference < 0) {
+      return false; // Full, the writer is behind
+    } else {
+      position = atomic_load_explicit(&logState.head, memory_order_relaxed);
+    }
+  }
+
+  slot->level = (uint8_t)level;
+  slot->category = (uint8_t)category;
+  memcpy(slot->text, text, strlen(text) + 1); // `text` is at most LOG_MESSAGE_SIZE with its terminator
+  atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+  return true;
+}
+
+static void logPrint(int level, int category, const char *text) {
+  printf("[%s] %s: %s\n", logLevelNames[level], logCategoryNames[category], text);
+}
+
+static void logWriterThread(void *arg) {
+  (void)arg;
+  for (;;) {
+    LogSlot *slot = &logState.slots[logState.tail & (LOG_RING_SIZE - 1)];
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) == logState.tail + 1) {
+      logPrint(slot->level, slot->category, slot->text);
+      atomic_store_explicit(&slot->sequence, logState.tail + LOG_RING_SIZE, memory_order_release);
+      logState.tail++;
+      atomic_store_explicit(&logState.written, logState.tail, memory_order_release);
+      continue;
+    }
+
+    unsigned int dropped = atomic_exchange(&logState.dropped, 0);
+    if (dropped) printf("[WARN] renderer: Log buffer full, dropped %u messages\n", dropped);
+    fflush(stdout);
+    if (!atomic_load(&logState.running)) break;
+    RenderSleep(0.002);
+  }
+}
+
+static void logStart(void) {
+  for (size_t i = 0; i < LOG_RING_SIZE; i++) {
+    atomic_init(&logState.slots[i].sequence, i);
+  }
+  atomic_store(&logState.head, 0);
+  atomic_store(&logState.written, 0);
+  logState.tail = 0;
+  atomic_store(&logState.running, true);
+  if (!RenderThreadStart(&logState.thread, logWriterThread, NULL)) atomic_store(&logState.running, false);
+}
+
+static void logStop(void) {
+  if (!atomic_load(&logState.running)) return;
+  atomic_store(&logState.running, false);
+  RenderThreadJoin(logState.thread);
+}
+
+void LogWrite(LogSite *site, int level, LogCategory category, const char *format, ...) {
+  if (logState.categoryDisabled[category]) return;
+
+  char text[LOG_MESSAGE_SIZE];
+  int32_t length = 0;
+  // Whichever thread moves the site to a new second resets it and reports what the last one suppressed
+  uint64_t window = (uint64_t)GetTime() + 1; // 0 is a site that never logged
+  uint64_t current = atomic_load(&site->window);
+  if (current != window && atomic_compare_exchange_strong(&site->window, &current, window)) {
+    atomic_store(&site->count, 0);
+    unsigned int suppressed = (unsigned int)atomic_exchange(&site->suppressed, 0);
+    if (suppressed) length = snprintf(text, sizeof(text), "(%u similar messages suppressed) ", suppressed);
+  }
+
+  if (atomic_fetch_add(&site->count, 1) >= RENDERER_LOG_BURST) {
+    atomic_fetch_add(&site->suppressed, 1);
+    return;
+  }
+
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text + length, sizeof(text) - length, format, args);
+  va_end(args);
+
+  // Before `RenderSetup` starts the writer, and after it stops, there's no frame to block
+  if (!atomic_load(&logState.running)) {
+    logPrint(level, category, text);
+    return;
+  }
+
+  if (!logPush(level, category, text)) atomic_fetch_add(&logState.dropped, 1);
+}
+
+void LogSetCategoryEnabled(LogCategory category, bool enabled) {
+  logState.categoryDisabled[category] = !enabled;
+}
+
+void LogFlush(void) {
+  if (!atomic_load(&logState.running)) {
+    fflush(stdout);
+    return;
+  }
+
+  size_t target = atomic_load(&logState.head);
+  while (atomic_load_explicit(&logState.written, memory_order_acquire) < target) {
+    RenderSleep(0.001);
+  }
+}
+
+/* Our renderer.h specifics */
+Renderer renderer = {0};
+void HandleClayErrors(Clay_ErrorData errorData) {
+  LogWarn(LOG_CATEGORY_CLAY, "%.*s", errorData.errorText.length, errorData.errorText.chars);
+
+  if (errorData.errorType == CLAY_ERROR_TYPE_ELEMENTS_CAPACITY_EXCEEDED) {
+    renderer.reinitialize = true;
+    Clay_SetMaxElementCount(Clay_GetMaxElementCount() * 2);
+    RENDERER_PROBE2(capacity_exceeded, errorData.errorType, Clay_GetMaxElementCount());
+    return;
+  }
+
+  if (errorData.errorType == CLAY_ERROR_TYPE_TEXT_MEASUREMENT_CAPACITY_EXCEEDED) {
+    renderer.reinitialize = true;
+    Clay_SetMaxMeasureTextCacheWordCount(Clay_GetMaxMeasureTextCacheWordCount() * 2);
+    RENDERER_PROBE2(capacity_exceeded, errorData.errorType, Clay_GetMaxMeasureTextCacheWordCount());
+    return;
+  }
+}
+
+/* Input recording and replay */
+static struct {
+  InputMode mode;
+  FILE *file;
+  InputFrame frame;
+  uint8_t previousMouseButtons;
+  uint8_t keysDown[(INPUT_MAX_KEYS + 7) / 8];
+  int32_t nextChar;
+} input = {0};
+
+static const char inputMagic[4] = {'R', 'I', 'N', 'P'};
+#define INPUT_FORMAT_VERSION 2 // 1 was the raw struct fields after a "RIN1" magic
+#define INPUT_FRAME_HEADER_SIZE 27 // 5 floats, 2 uint16_t and 3 uint8_t
+
+static uint8_t *inputPut(uint8_t *out, uint32_t value, int32_t bytes) {
+  for (int32_t i = 0; i < bytes; i++) out[i] = (uint8_t)(value >> (8 * i));
+  return out + bytes;
+}
+
+static uint32_t inputGet(const uint8_t **in, int32_t bytes) {
+  uint32_t value = 0;
+  for (int32_t i = 0; i < bytes; i++) value |= (uint32_t)(*in)[i] << (8 * i);
+  *in += bytes;
+  return value;
+}
+
+static uint8_t *inputPutFloat(uint8_t *out, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return inputPut(out, bits, 4);
+}
+
+static float inputGetFloat(const uint8_t **in) {
+  uint32_t bits = inputGet(in, 4);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static void inputClose(void) {
+  if (input.file) fclose(input.file);
+  input.file = NULL;
+}
+
+static void inputInit(RenderOptions options) {
+  assert(!(options.inputRecordPath && options.inputReplayPath) && "Can't record and replay input at the same time");
+
+  // A file that can't be used is logged and the session runs on live input instead
+  if (options.inputRecordPath) {
+    uint8_t header[8];
+    memcpy(header, inputMagic, sizeof(inputMagic));
+    inputPut(header + sizeof(inputMagic), INPUT_FORMAT_VERSION, 4);
+    input.file = fopen(options.inputRecordPath, "wb");
+    if (!input.file || fwrite(header, 1, sizeof(header), input.file) != sizeof(header)) {
+      LogError(LOG_CATEGORY_INPUT, "Couldn't open %s for recording, using live input", options.inputRecordPath);
+      inputClose();
+      return;
+    }
+    input.mode = INPUT_RECORD;
+  }
+
+  if (options.inputReplayPath) {
+    uint8_t header[8] = {0};
+    input.file = fopen(options.inputReplayPath, "rb");
+    if (!input.file || fread(header, 1, sizeof(header), input.file) != sizeof(header) || memcmp(header, inputMagic, sizeof(inputMagic)) != 0) {
+      LogError(LOG_CATEGORY_INPUT, "%s isn't a readable input recording, using live input", options.inputReplayPath);
+      inputClose();
+      return;
+    }
+    const uint8_t *versionBytes = header + sizeof(inputMagic);
+    uint32_t version = inputGet(&versionBytes, 4);
+    if (version != INPUT_FORMAT_VERSION) {
+      LogError(LOG_CATEGORY_INPUT, "%s is an input recording of version %u, only version %d can be replayed, using live input", options.inputReplayPath, version, INPUT_FORMAT_VERSION);
+      inputClose();
+      return;
+    }
+    input.mode = INPUT_REPLAY;
+  }
+}
+
+static void captureInputFrame(InputFrame *frame) {
+  Vector2 mousePosition = GetMousePosition();
+  Vector2 mouseWheel = GetMouseWheelMoveV();
+  *frame = (InputFrame){
+      .mouseX = mousePosition.x,
+      .mouseY = mousePosition.y,
+      .wheelX = mouseWheel.x,
+      .wheelY = mouseWheel.y,
+      .frameTime = GetFrameTime(),
+      .width = (uint16_t)GetScreenWidth(),
+      .height = (uint16_t)GetScreenHeight(),
+  };
+
+  for (int button = 0; button < 7; button++) {
+    if (IsMouseButtonDown(button)) frame->mouseButtons |= 1 << button;
+  }
+
+  // Walking every key is cheap next to the frame and doesn't consume raylib's key queue like GetKeyPressed does.
+  // A key can go down and up within one frame, every transition is kept in the order that leaves it in its state
+  int32_t dropped = 0;
+  for (int key = 1; key < INPUT_MAX_KEYS; key++) {
+    bool pressed = IsKeyPressed(key);
+    bool released = IsKeyReleased(key);
+    bool down = IsKeyDown(key);
+    bool repeat = IsKeyPressedRepeat(key);
+    int32_t events = (released && pressed && down) + pressed + repeat + (released && !(pressed && down));
+    if (events == 0) continue;
+    // A key's transitions are kept or dropped together so its state doesn't go out of sync
+    if (frame->keyCount + events > INPUT_MAX_EVENTS) {
+      dropped += events;
+      continue;
+    }
+    if (released && pressed && down) frame->keys[frame->keyCount++] = (uint16_t)key | INPUT_KEY_RELEASED;
+    if (pressed) frame->keys[frame->keyCount++] = (uint16_t)key;
+    if (repeat) frame->keys[frame->keyCount++] = (uint16_t)key | INPUT_KEY_REPEAT;
+    if (released && !(pressed && down)) frame->keys[frame->keyCount++] = (uint16_t)key | INPUT_KEY_RELEASED;
+  }
+
+  int codepoint;
+  while ((codepoint = GetCharPressed()) != 0) {
+    if (frame->charCount < INPUT_MAX_EVENTS) frame->chars[frame->charCount++] = (uint32_t)codepoint;
+    else dropped++;
+  }
+  if (dropped > 0) LogWarn(LOG_CATEGORY_INPUT, "Frame %llu had %d more key and char events than the %d recorded", (unsigned long long)renderer.frameIndex, dropped, INPUT_MAX_EVENTS);
+}
+
+// Fixed fields first, then only as many key and char events as the frame had
+static void writeInputFrame(InputFrame *frame, FILE *file) {
+  uint8_t buffer[INPUT_FRAME_HEADER_SIZE + INPUT_MAX_EVENTS * (sizeof(uint16_t) + sizeof(uint32_t))];
+  uint8_t *out = buffer;
+  out = inputPutFloat(out, frame->mouseX);
+  out = inputPutFloat(out, frame->mouseY);
+  out = inputPutFloat(out, frame->wheelX);
+  out = inputPutFloat(out, frame->wheelY);
+  out = inputPutFloat(out, frame->frameTime);
+  out = inputPut(out, frame->width, 2);
+  out = inputPut(out, frame->height, 2);
+  out = inputPut(out, frame->mouseButtons, 1);
+  out = inputPut(out, frame->keyCount, 1);
+  out = inputPut(out, frame->charCount, 1);
+  for (int32_t i = 0; i < frame->keyCount; i++) out = inputPut(out, frame->keys[i], 2);
+  for (int32_t i = 0; i < frame->charCount; i++) out = inputPut(out, frame->chars[i], 4);
+  fwrite(buffer, 1, out - buffer, file);
+}
+
+static bool readInputFrame(InputFrame *frame, FILE *file) {
+  *frame = (InputFrame){0};
+  uint8_t buffer[INPUT_FRAME_HEADER_SIZE + INPUT_MAX_EVENTS * (sizeof(uint16_t) + sizeof(uint32_t))];
+  if (fread(buffer, 1, INPUT_FRAME_HEADER_SIZE, file) != INPUT_FRAME_HEADER_SIZE) return false;
+
+  const uint8_t *in = buffer;
+  frame->mouseX = inputGetFloat(&in);
+  frame->mouseY = inputGetFloat(&in);
+  frame->wheelX = inputGetFloat(&in);
+  frame->wheelY = inputGetFloat(&in);
+  frame->frameTime = inputGetFloat(&in);
+  frame->width = (uint16_t)inputGet(&in, 2);
+  frame->height = (uint16_t)inputGet(&in, 2);
+  frame->mouseButtons = (uint8_t)inputGet(&in, 1);
+  frame->keyCount = (uint8_t)inputGet(&in, 1);
+  frame->charCount = (uint8_t)inputGet(&in, 1);
+  if (frame->keyCount > INPUT_MAX_EVENTS || frame->charCount > INPUT_MAX_EVENTS) return false;
+
+  size_t eventsSize = frame->keyCount * sizeof(uint16_t) + frame->charCount * sizeof(uint32_t);
+  if (fread(buffer, 1, eventsSize, file) != eventsSize) return false;
+  in = buffer;
+  for (int32_t i = 0; i < frame->keyCount; i++) frame->keys[i] = (uint16_t)inputGet(&in, 2);
+  for (int32_t i = 0; i < frame->charCount; i++) frame->chars[i] = inputGet(&in, 4);
+  return true;
+}
+
+// Returns false once a replay runs out of frames
+static bool inputBeginFrame(void) {
+  input.previousMouseButtons = input.frame.mouseButtons;
+  input.nextChar = 0;
+
+  if (input.mode == INPUT_LIVE) return true;
+
+  if (input.mode == INPUT_RECORD) {
+    captureInputFrame(&input.frame);
+    writeInputFrame(&input.frame, input.file);
+  } else {
+    if (!readInputFrame(&input.frame, input.file)) return false;
+    // Match the recorded window so layouts come out the same
+    if (input.frame.width != GetScreenWidth() || input.frame.height != GetScreenHeight()) SetWindowSize(input.frame.width, input.frame.height);
+  }
+
+  for (int32_t i = 0; i < input.frame.keyCount; i++) {
+    uint16_t key = input.frame.keys[i] & ~(INPUT_KEY_REPEAT | INPUT_KEY_RELEASED);
+    if (key >= INPUT_MAX_KEYS) continue;
+    if (input.frame.keys[i] & INPUT_KEY_RELEASED) input.keysDown[key / 8] &= ~(1 << (key % 8));
+    else input.keysDown[key / 8] |= 1 << (key % 8);
+  }
+  return true;
+}
+
+static bool inputHasKeyEvent(int key, uint16_t flags) {
+  for (int32_t i = 0; i < input.frame.keyCount; i++) {
+    if (input.frame.keys[i] == ((uint16_t)key | flags)) return true;
+  }
+  return false;
+}
+
+Vector2 InputMousePosition(void) {
+  if (input.mode == INPUT_LIVE) return GetMousePosition();
+  return (Vector2){input.frame.mouseX, input.frame.mouseY};
+}
+
+bool InputMouseButtonDown(int button) {
+  if (input.mode == INPUT_LIVE) return IsMouseButtonDown(button);
+  return input.frame.mouseButtons & (1 << button);
+}
+
+bool InputMouseButtonPressed(int button) {
+  if (input.mode == INPUT_LIVE) return IsMouseButtonPressed(button);
+  return (input.frame.mouseButtons & (1 << button)) && !(input.previousMouseButtons & (1 << button));
+}
+
+Vector2 InputMouseWheel(void) {
+  if (input.mode == INPUT_LIVE) return GetMouseWheelMoveV();
+  return (Vector2){input.frame.wheelX, input.frame.wheelY};
+}
+
+bool InputKeyDown(int key) {
+  if (input.mode == INPUT_LIVE) return IsKeyDown(key);
+  if (key <= 0 || key >= INPUT_MAX_KEYS) return false;
+  return input.keysDown[key / 8] & (1 << (key % 8));
+}
+
+bool InputKeyPressed(int key) {
+  if (input.mode == INPUT_LIVE) return IsKeyPressed(key);
+  return inputHasKeyEvent(key, 0);
+}
+
+bool InputKeyPressedRepeat(int key) {
+  if (input.mode == INPUT_LIVE) return IsKeyPressedRepeat(key);
+  return inputHasKeyEvent(key, INPUT_KEY_REPEAT);
+}
+
+bool InputKeyReleased(int key) {
+  if (input.mode == INPUT_LIVE) return IsKeyReleased(key);
+  return inputHasKeyEvent(key, INPUT_KEY_RELEASED);
+}
+
+int InputCharPressed(void) {
+  if (input.mode == INPUT_LIVE) return GetCharPressed();
+  if (input.nextChar >= input.frame.charCount) return 0;
+  return (int)input.frame.chars[input.nextChar++];
+}
+
+float InputFrameTime(void) {
+  if (input.mode == INPUT_LIVE) return GetFrameTime();
+  return input.frame.frameTime;
+}
+
+int InputScreenWidth(void) {
+  if (input.mode == INPUT_LIVE) return GetScreenWidth();
+  return input.frame.width;
+}
+
+int InputScreenHeight(void) {
+  if (input.mode == INPUT_LIVE) return GetScreenHeight();
+  return input.frame.height;
+}
+
+static void initDraw() {
+  // The previous frame's `EndDrawing` flushed the batch, count it before starting over
+  countFlush();
+  renderer.frameCounters = renderer.counters;
+  renderer.counters = (RenderCounters){0};
+
+  if (InputKeyPressed(KEY_F2)) {
+    renderer.debugEnabled = !renderer.debugEnabled;
+    Clay_SetDebugModeEnabled(renderer.debugEnabled);
+  }
+
+  Clay_Vector2 mousePosition = RAYLIB_VECTOR2_TO_CLAY_VECTOR2(InputMousePosition());
+  Clay_SetPointerState(mousePosition, InputMouseButtonDown(0));
+  Clay_SetLayoutDimensions((Clay_Dimensions){(float)InputScreenWidth(), (float)InputScreenHeight()});
+
+  Vector2 mouseWheelDelta = InputMouseWheel();
+  float mouseWheelX = mouseWheelDelta.x;
+  float mouseWheelY = mouseWheelDelta.y;
+  Clay_UpdateScrollContainers(true, (Clay_Vector2){mouseWheelX, mouseWheelY}, InputFrameTime());
+}
+
+void BeginLayout(void) {
+  RENDERER_PROBE1(layout_start, renderer.frameIndex);
+  renderer.layoutStart = GetTime();
+  ArenaReset(&renderer.frameArena);
+  Clay_BeginLayout();
+}
+
+Clay_RenderCommandArray EndLayout(void) {
+  Clay_RenderCommandArray renderCommands = Clay_EndLayout();
+  HistogramRecord(&renderer.phases[RENDER_PHASE_LAYOUT], (uint32_t)((GetTime() - renderer.layoutStart) * 1e6));
+  RENDERER_PROBE2(layout_end, renderer.frameIndex, renderCommands.length);
+  return renderCommands;
+}
+
+ScrollHandle ScrollHandleGet(char *containerName) {
+  return (ScrollHandle){.id = Clay__HashString(toClayString(containerName), 0, 0)};
+}
+
+bool ScrollHandleResolve(ScrollHandle *handle) {
+  if (handle->resolvedFrame != renderer.frameIndex + 1) {
+    handle->data = Clay_GetScrollContainerData(handle->id);
+    handle->resolvedFrame = renderer.frameIndex + 1;
+  }
+  return handle->data.found;
+}
+
+void ScrollHandleByY(ScrollHandle *handle, float deltaY) {
+  if (!ScrollHandleResolve(handle)) return;
+  Clay_ScrollContainerData *data = &handle->data;
+  float newScrollY = data->scrollPosition->y + deltaY;
+  float minScrollY = -fmaxf(0, data->contentDimensions.height - data->scrollContainerDimensions.height);
+  float newValue = fminf(0, fmaxf(newScrollY, minScrollY));
+  if (newValue == 0) {
+    LogDebug(LOG_CATEGORY_SCROLL, "Scroll clamped to the top, deltaY: %f, minPos: %f, newPos: %f", deltaY, minScrollY, newValue);
+  }
+  data->scrollPosition->y = newValue;
+}
+
+void ScrollHandleByX(ScrollHandle *handle, float deltaX) {
+  if (!ScrollHandleResolve(handle)) return;
+  Clay_ScrollContainerData *data = &handle->data;
+  float newScrollX = data->scrollPosition->x + deltaX;
+  float minScrollX = -fmaxf(0, data->contentDimensions.width - data->scrollContainerDimensions.width);
+  data->scrollPosition->x = fminf(0, fmaxf(newScrollX, minScrollX));
+}
+
+void ScrollHandleTop(ScrollHandle *handle) {
+  if (!ScrollHandleResolve(handle)) return;
+  handle->data.scrollPosition->y = 0;
+}
+
+void ScrollHandleBottom(ScrollHandle *handle) {
+  if (!ScrollHandleResolve(handle)) return;
+  Clay_ScrollContainerData *data = &handle->data;
+  data->scrollPosition->y = -fmaxf(0, data->contentDimensions.height - data->scrollContainerDimensions.height);
+}
+
+void ScrollContainersBy(ScrollUpdate *updates, int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    if (updates[i].deltaX != 0) ScrollHandleByX(updates[i].handle, updates[i].deltaX);
+    if (updates[i].deltaY != 0) ScrollHandleByY(updates[i].handle, updates[i].deltaY);
+  }
+}
+
+// Name based versions, these hash the name on every call so prefer handles for anything called per frame
+void ScrollContainerByY(char *containerName, float deltaY) {
+  ScrollHandle handle = ScrollHandleGet(containerName);
+  ScrollHandleByY(&handle, deltaY);
+}
+
+void ScrollContainerTop(char *containerName) {
+  ScrollHandle handle = ScrollHandleGet(containerName);
+  ScrollHandleTop(&handle);
+}
+
+void ScrollContainerBottom(char *containerName) {
+  ScrollHandle handle = ScrollHandleGet(containerName);
+  ScrollHandleBottom(&handle);
+}
+
+void ScrollContainerByX(char *containerName, float deltaX) {
+  ScrollHandle handle = ScrollHandleGet(containerName);
+  ScrollHandleByX(&handle, deltaX);
+}
+
+Clay_String s(const char *msg) {
+  return (Clay_String){
+      .length = strlen(msg),
+      .chars = msg,
+  };
+}
+
+#ifdef RENDERER_ALLOC_HOOKS
+#define ALLOC_CHECK_SAMPLES 4
+#define ALLOC_CHECK_STACK_DEPTH 24
+
+typedef struct {
+  void *stack[ALLOC_CHECK_STACK_DEPTH];
+  int32_t depth;
+  size_t size;
+} AllocSample;
+
+static struct {
+  bool checking;
+  int32_t warmupFrames;
+  bool abortOnAlloc;
+  uint64_t frameAllocations;
+  size_t frameBytes;
+  AllocSample samples[ALLOC_CHECK_SAMPLES];
+  int32_t sampleCount;
+} allocCheck = {0};
+
+// Only the render thread is checked, `inAllocHook` stops backtrace() from recursing into us
+static __thread bool isRenderThread = false;
+static __thread bool inAllocHook = false;
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+static void allocCheckRecord(size_t size) {
+  if (!allocCheck.checking || !isRenderThread || inAllocHook) return;
+
+  inAllocHook = true;
+  allocCheck.frameAllocations++;
+  allocCheck.frameBytes += size;
+  if (allocCheck.sampleCount < ALLOC_CHECK_SAMPLES) {
+    AllocSample *sample = &allocCheck.samples[allocCheck.sampleCount++];
+    sample->depth = backtrace(sample->stack, ALLOC_CHECK_STACK_DEPTH);
+    sample->size = size;
+  }
+  inAllocHook = false;
+}
+
+void *malloc(size_t size) {
+  allocCheckRecord(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  allocCheckRecord(count * size);
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  allocCheckRecord(size);
+  return __libc_realloc(ptr, size);
+}
+
+// glibc has no `__libc_*` entry for the standard aligned allocators, they all end up in memalign
+void *memalign(size_t alignment, size_t size) {
+  allocCheckRecord(size);
+  return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  allocCheckRecord(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+  if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) return EINVAL;
+  allocCheckRecord(size);
+  void *result = __libc_memalign(alignment, size);
+  if (!result && size > 0) return ENOMEM;
+  *ptr = result;
+  return 0;
+}
+
+void free(void *ptr) {
+  __libc_free(ptr);
+}
+
+static void allocCheckInit(RenderOptions options) {
+  isRenderThread = true;
+  allocCheck.warmupFrames = options.allocWarmupFrames ? options.allocWarmupFrames : 60;
+  allocCheck.abortOnAlloc = options.allocAbort;
+
+  // backtrace() lazily loads libgcc on its first call, get that allocation out of the way
+  void *warmup[1];
+  backtrace(warmup, 1);
+}
+
+static void allocCheckBeginFrame(void) {
+  allocCheck.checking = renderer.frameIndex >= (uint64_t)allocCheck.warmupFrames;
+  allocCheck.frameAllocations = 0;
+  allocCheck.frameBytes = 0;
+  allocCheck.sampleCount = 0;
+}
+
+static void allocCheckEndFrame(void) {
+  allocCheck.checking = false;
+  if (allocCheck.frameAllocations == 0) return;
+
+  fprintf(stderr, "Frame %llu allocated %llu times (%zu bytes)\n", (unsigned long long)renderer.frameIndex, (unsigned long long)allocCheck.frameAllocations, allocCheck.frameBytes);
+  for (int32_t i = 0; i < allocCheck.sampleCount; i++) {
+    AllocSample *sample = &allocCheck.samples[i];
+    fprintf(stderr, "  Allocation of %zu bytes:\n", sample->size);
+    backtrace_symbols_fd(sample->stack, sample->depth, fileno(stderr));
+  }
+
+  if (allocCheck.abortOnAlloc) abort();
+}
+#else
+#ifdef RENDERER_ALLOC_CHECK
+#warning "RENDERER_ALLOC_CHECK needs glibc, the allocation checker is disabled"
+#endif
+#define allocCheckInit(options)
+#define allocCheckBeginFrame()
+#define allocCheckEndFrame()
+#endif
+
+void RenderSetup(RenderOptions options, Callback updateCallback, Callback drawCallback) {
+  renderer.totalMemorySize = Clay_MinMemorySize();
+  renderer.clayMemory = Clay_CreateArenaWithCapacityAndMemory(renderer.totalMemorySize, malloc(renderer.totalMemorySize));
+  Clay_Initialize(renderer.clayMemory, (Clay_Dimensions){(float)GetScreenWidth(), (float)GetScreenHeight()}, (Clay_ErrorHandler){HandleClayErrors, 0});
+  Clay_Raylib_Initialize(options.width, options.height, options.windowName, FLAG_VSYNC_HINT | FLAG_WINDOW_RESIZABLE | FLAG_WINDOW_HIGHDPI | FLAG_MSAA_4X_HINT);
+  int32_t batchElements = options.batchElements ? options.batchElements : RL_DEFAULT_BATCH_BUFFER_ELEMENTS;
+  renderBatch.batch = rlLoadRenderBatch(options.batchBuffers ? options.batchBuffers : RL_DEFAULT_BATCH_BUFFERS, batchElements);
+  renderBatch.capacity = batchElements * 4;
+  rlSetRenderBatchActive(&renderBatch.batch);
+  renderer.frameArena = ArenaInit(options.frameArenaSize ? options.frameArenaSize : 4 * 1024 * 1024);
+
+  renderer.fonts[FONT_18] = LoadFontEx(options.fontPath, 18, 0, 250);
+  SetTextureFilter(renderer.fonts[FONT_18].texture, TEXTURE_FILTER_BILINEAR);
+  renderer.fonts[FONT_20] = LoadFontEx(options.fontPath, 20, 0, 250);
+  SetTextureFilter(renderer.fonts[FONT_20].texture, TEXTURE_FILTER_BILINEAR);
+  renderer.fonts[FONT_22] = LoadFontEx(options.fontPath, 22, 0, 250);
+  SetTextureFilter(renderer.fonts[FONT_22].texture, TEXTURE_FILTER_BILINEAR);
+  renderer.fonts[FONT_24] = LoadFontEx(options.fontPath, 24, 0, 250);
+  SetTextureFilter(renderer.fonts[FONT_24].texture, TEXTURE_FILTER_BILINEAR);
+
+  // GenTextureMipmaps(&renderer.font[FONT_24].texture);
+  Clay_SetMeasureTextFunction(Raylib_MeasureText, &renderer.fonts);
+  allocCheckInit(options);
+  renderer.statsPath = options.statsPath;
+  renderer.statsInterval = options.statsInterval;
+  renderer.lastStatsExport = GetTime();
+  logStart();
+  inputInit(options);
+  while (!renderer.shouldClose) {
+    double frameStart = GetTime();
+    if (!inputBeginFrame()) break;
+    if (InputKeyPressed(KEY_ESCAPE) || WindowShouldClose()) renderer.shouldClose = true;
+
+    if (renderer.reinitialize) {
+      // The previous frame's commands are already drawn, nothing points into the old memory anymore
+      free(renderer.clayMemory.memory);
+      Clay_SetMaxElementCount(8192);
+      renderer.totalMemorySize = Clay_MinMemorySize();
+      renderer.clayMemory = Clay_CreateArenaWithCapacityAndMemory(renderer.totalMemorySize, malloc(renderer.totalMemorySize));
+      Clay_Initialize(renderer.clayMemory, (Clay_Dimensions){(float)GetScreenWidth(), (float)GetScreenHeight()}, (Clay_ErrorHandler){HandleClayErrors, 0});
+      renderer.reinitialize = false;
+      RENDERER_PROBE1(arena_grow, renderer.totalMemorySize);
+    }
+
+    RENDERER_PROBE1(frame_start, renderer.frameIndex);
+    allocCheckBeginFrame();
+    double updateStart = GetTime();
+    initDraw();
+    updateCallback();
+    double updateEnd = GetTime();
+    drawCallback();
+    allocCheckEndFrame();
+    double frameEnd = GetTime();
+    RENDERER_PROBE1(frame_end, renderer.frameIndex);
+    renderer.frameIndex++;
+
+    HistogramRecord(&renderer.phases[RENDER_PHASE_FRAME], (uint32_t)((frameEnd - frameStart) * 1e6));
+    HistogramRecord(&renderer.phases[RENDER_PHASE_UPDATE], (uint32_t)((updateEnd - updateStart) * 1e6));
+    HistogramRecord(&renderer.phases[RENDER_PHASE_DRAW], (uint32_t)((frameEnd - updateEnd) * 1e6));
+    if (renderer.statsPath && renderer.statsInterval > 0 && frameEnd - renderer.lastStatsExport >= renderer.statsInterval) {
+      ExportFrameStats(renderer.statsPath);
+      renderer.lastStatsExport = frameEnd;
+    }
+  }
+
+  if (renderer.statsPath) ExportFrameStats(renderer.statsPath);
+  inputClose();
+  logStop();
+  renderPoolStop();
+  rlSetRenderBatchActive(NULL);
+  rlUnloadRenderBatch(renderBatch.batch);
+  ArenaFree(&renderer.frameArena);
+  CloseWindow();
+}
+
+Clay_String F(Arena *arena, const char *format, ...) {
+  // Get formatted string size
+  va_list args;
+  va_start(args, format);
+  size_t size = vsnprintf(NULL, 0, format, args) + 1; // +1 for null terminator
+  va_end(args);
+
+  // Allocate based on size
+  char *buffer = (char *)ArenaAlloc(arena, size);
+  va_start(args, format);
+  vsnprintf(buffer, size, format, args);
+  va_end(args);
+
+  return (Clay_String){.length = size - 1, .chars = buffer};
+}
+
+// Empty element standing in for content that isn't declared
+static Clay_ElementDeclaration spacerDeclaration(Clay_SizingAxis width, Clay_SizingAxis height) {
+  return (Clay_ElementDeclaration){.layout = {.sizing = {.width = width, .height = height}}};
+}
+
+static Clay_ElementDeclaration customDeclaration(Clay_SizingAxis width, Clay_SizingAxis height, CustomLayoutElement *element) {
+  return (Clay_ElementDeclaration){.layout = {.sizing = {.width = width, .height = height}}, .custom = {.customData = element}};
+}
+
+void VirtualListDeclare(VirtualListOptions options) {
+  assert(options.id && "VirtualList needs an id to read its scroll position");
+  assert(options.rowHeight > 0 && "VirtualList needs a row height");
+
+  int32_t overscan = options.overscan ? options.overscan : 4;
+
+  // Scroll position and viewport come from the last layout, before the first one assume the screen is the viewport
+  float scrollY = 0;
+  float viewportHeight = (float)InputScreenHeight();
+  ScrollHandle handle = ScrollHandleGet(options.id);
+  if (ScrollHandleResolve(&handle)) {
+    scrollY = -handle.data.scrollPosition->y;
+    viewportHeight = handle.data.scrollContainerDimensions.height;
+  }
+
+  int32_t first = CLAY__MAX(0, (int32_t)(scrollY / options.rowHeight) - overscan);
+  int32_t last = CLAY__MIN(options.rowCount, (int32_t)ceilf((scrollY + viewportHeight) / options.rowHeight) + overscan);
+  first = CLAY__MIN(first, last);
+
+  Column(.id = options.id, .scroll = "v", .w = options.w, .h = options.h, .bg = options.bg) {
+    if (first > 0) {
+      CLAY(spacerDeclaration(CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(first * options.rowHeight))) {}
+    }
+
+    for (int32_t row = first; row < last; row++) {
+      options.onRow(row, options.userData);
+    }
+
+    if (last < options.rowCount) {
+      CLAY(spacerDeclaration(CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED((options.rowCount - last) * options.rowHeight))) {}
+    }
+  }
+}
+
+static void virtualGridMeasure(VirtualGridOptions *options) {
+  VirtualGridState *state = options->state;
+  if (state->columnOffsets && state->columnCount == options->columnCount) return;
+
+  free(state->columnOffsets);
+  state->columnOffsets = (double *)malloc(sizeof(double) * (options->columnCount + 1));
+  state->columnCount = options->columnCount;
+  state->columnOffsets[0] = 0;
+  for (int32_t column = 0; column < options->columnCount; column++) {
+    float width = 100;
+    if (options->columnWidths) width = options->columnWidths[column];
+    else if (options->measureColumn) width = options->measureColumn(column, options->userData);
+    state->columnOffsets[column + 1] = state->columnOffsets[column] + width;
+  }
+}
+
+void VirtualGridInvalidate(VirtualGridState *state) {
+  free(state->columnOffsets);
+  state->columnOffsets = NULL;
+  state->columnCount = 0;
+}
+
+void VirtualGridFree(VirtualGridState *state) {
+  VirtualGridInvalidate(state);
+  state->lastScroll = (Clay_Vector2){0};
+}
+
+// First column whose right edge is past `x`
+static int32_t virtualGridColumnAt(VirtualGridState *state, int32_t firstColumn, double x) {
+  int32_t low = firstColumn;
+  int32_t high = state->columnCount;
+  while (low < high) {
+    int32_t middle = low + (high - low) / 2;
+    if (state->columnOffsets[middle + 1] - state->columnOffsets[firstColumn] <= x) low = middle + 1;
+    else high = middle;
+  }
+  return low;
+}
+
+static Clay_ElementDeclaration virtualGridPane(Clay_ElementId id, Clay_SizingAxis width, Clay_SizingAxis height, Clay_LayoutDirection direction, Clay_ScrollElementConfig scroll, Clay_Color bg) {
+  return (Clay_ElementDeclaration){.id = id, .layout = {.sizing = {.width = width, .height = height}, .layoutDirection = direction}, .scroll = scroll, .backgroundColor = bg};
+}
+
+static void virtualGridCells(VirtualGridOptions *options, int32_t row, int32_t firstColumn, int32_t lastColumn) {
+  float height = row == VIRTUAL_GRID_HEADER ? options->headerHeight : options->rowHeight;
+  for (int32_t column = firstColumn; column < lastColumn; column++) {
+    float width = (float)(options->state->columnOffsets[column + 1] - options->state->columnOffsets[column]);
+    CLAY(spacerDeclaration(CLAY_SIZING_FIXED(width), CLAY_SIZING_FIXED(height))) {
+      options->onCell(row, column, options->userData);
+    }
+  }
+}
+
+// Declares one row of scrolling columns, spacers keep the row as wide as all of them
+static void virtualGridRow(VirtualGridOptions *options, int32_t row, int32_t firstColumn, int32_t lastColumn) {
+  VirtualGridState *state = options->state;
+  int32_t sticky = options->stickyColumns;
+  float height = row == VIRTUAL_GRID_HEADER ? options->headerHeight : options->rowHeight;
+  CLAY(virtualGridPane((Clay_ElementId){0}, CLAY_SIZING_FIT(0), CLAY_SIZING_FIXED(height), CLAY_LEFT_TO_RIGHT, (Clay_ScrollElementConfig){0}, NONE)) {
+    if (firstColumn > sticky) {
+      CLAY(spacerDeclaration(CLAY_SIZING_FIXED((float)(state->columnOffsets[firstColumn] - state->columnOffsets[sticky])), CLAY_SIZING_FIXED(height))) {}
     }
-    case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
-      Texture2D imageTexture = *(Texture2D *)renderCommand->renderData.image.imageData;
-      Clay_Color tintColor = renderCommand->renderData.image.backgroundColor;
-      if (tintColor.r == 0 && tintColor.g == 0 && tintColor.b == 0 && tintColor.a == 0) {
-        tintColor = (Clay_Color){255, 255, 255, 255};
+    virtualGridCells(options, row, firstColumn, lastColumn);
+    if (lastColumn < options->columnCount) {
+      CLAY(spacerDeclaration(CLAY_SIZING_FIXED((float)(state->columnOffsets[options->columnCount] - state->columnOffsets[lastColumn])), CLAY_SIZING_FIXED(height))) {}
+    }
+  }
+}
+
+void VirtualGridDeclare(VirtualGridOptions options) {
+  assert(options.id && options.state && "VirtualGrid needs an id and a state");
+  assert(options.rowHeight > 0 && "VirtualGrid needs a row height");
+
+  virtualGridMeasure(&options);
+  VirtualGridState *state = options.state;
+  int32_t overscan = options.overscan ? options.overscan : 2;
+  int32_t sticky = CLAY__MIN(options.stickyColumns, options.columnCount);
+  options.stickyColumns = sticky;
+  float stickyWidth = (float)state->columnOffsets[sticky];
+
+  Clay_String idString = toClayString(options.id);
+  ScrollHandle header = {.id = Clay__HashString(idString, 1, 0)};
+  ScrollHandle stickyPane = {.id = Clay__HashString(idString, 2, 0)};
+  ScrollHandle body = {.id = Clay__HashString(idString, 3, 0)};
+
+  // The body drives the sticky panes, unless one of them was scrolled directly since the last frame
+  Clay_Vector2 scroll = {0};
+  Clay_Dimensions viewport = {(float)InputScreenWidth(), (float)InputScreenHeight()};
+  if (ScrollHandleResolve(&body)) {
+    scroll = *body.data.scrollPosition;
+    viewport = body.data.scrollContainerDimensions;
+    if (ScrollHandleResolve(&header) && header.data.scrollPosition->x != state->lastScroll.x) scroll.x = header.data.scrollPosition->x;
+    if (ScrollHandleResolve(&stickyPane) && stickyPane.data.scrollPosition->y != state->lastScroll.y) scroll.y = stickyPane.data.scrollPosition->y;
+
+    *body.data.scrollPosition = scroll;
+    if (header.data.found) header.data.scrollPosition->x = scroll.x;
+    if (stickyPane.data.found) stickyPane.data.scrollPosition->y = scroll.y;
+    state->lastScroll = scroll;
+  }
+
+  int32_t firstRow = CLAY__MAX(0, (int32_t)(-scroll.y / options.rowHeight) - overscan);
+  int32_t lastRow = CLAY__MIN(options.rowCount, (int32_t)ceilf((-scroll.y + viewport.height) / options.rowHeight) + overscan);
+  firstRow = CLAY__MIN(firstRow, lastRow);
+  int32_t firstColumn = CLAY__MAX(sticky, virtualGridColumnAt(state, sticky, -scroll.x) - overscan);
+  int32_t lastColumn = CLAY__MIN(options.columnCount, virtualGridColumnAt(state, sticky, -scroll.x + viewport.width) + 1 + overscan);
+  firstColumn = CLAY__MIN(firstColumn, lastColumn);
+
+  Clay_SizingAxis topHeight = CLAY_SIZING_FIXED((float)((double)firstRow * options.rowHeight));
+  Clay_SizingAxis bottomHeight = CLAY_SIZING_FIXED((float)((double)(options.rowCount - lastRow) * options.rowHeight));
+  Column(.id = options.id, .w = options.w, .h = options.h, .bg = options.bg) {
+    if (options.headerHeight > 0) {
+      CLAY(virtualGridPane((Clay_ElementId){0}, CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(options.headerHeight), CLAY_LEFT_TO_RIGHT, (Clay_ScrollElementConfig){0}, options.headerBg)) {
+        if (sticky > 0) {
+          CLAY(virtualGridPane((Clay_ElementId){0}, CLAY_SIZING_FIXED(stickyWidth), CLAY_SIZING_GROW(0), CLAY_LEFT_TO_RIGHT, (Clay_ScrollElementConfig){0}, NONE)) {
+            virtualGridCells(&options, VIRTUAL_GRID_HEADER, 0, sticky);
+          }
+        }
+        CLAY(virtualGridPane(header.id, CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0), CLAY_LEFT_TO_RIGHT, (Clay_ScrollElementConfig){.horizontal = true}, NONE)) {
+          virtualGridRow(&options, VIRTUAL_GRID_HEADER, firstColumn, lastColumn);
+        }
       }
-      DrawTextureEx(imageTexture, (Vector2){boundingBox.x, boundingBox.y}, 0, boundingBox.width / (float)imageTexture.width, CLAY_COLOR_TO_RAYLIB_COLOR(tintColor));
-      break;
     }
-    case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
-      BeginScissorMode((int)roundf(boundingBox.x), (int)roundf(boundingBox.y), (int)roundf(boundingBox.width), (int)roundf(boundingBox.height));
-      break;
+
+    CLAY(virtualGridPane((Clay_ElementId){0}, CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0), CLAY_LEFT_TO_RIGHT, (Clay_ScrollElementConfig){0}, NONE)) {
+      if (sticky > 0) {
+        CLAY(virtualGridPane(stickyPane.id, CLAY_SIZING_FIXED(stickyWidth), CLAY_SIZING_GROW(0), CLAY_TOP_TO_BOTTOM, (Clay_ScrollElementConfig){.vertical = true}, NONE)) {
+          if (firstRow > 0) CLAY(spacerDeclaration(CLAY_SIZING_FIXED(stickyWidth), topHeight)) {}
+          for (int32_t row = firstRow; row < lastRow; row++) {
+            CLAY(virtualGridPane((Clay_ElementId){0}, CLAY_SIZING_FIT(0), CLAY_SIZING_FIXED(options.rowHeight), CLAY_LEFT_TO_RIGHT, (Clay_ScrollElementConfig){0}, NONE)) {
+              virtualGridCells(&options, row, 0, sticky);
+            }
+          }
+          if (lastRow < options.rowCount) CLAY(spacerDeclaration(CLAY_SIZING_FIXED(stickyWidth), bottomHeight)) {}
+        }
+      }
+
+      CLAY(virtualGridPane(body.id, CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0), CLAY_TOP_TO_BOTTOM, (Clay_ScrollElementConfig){.horizontal = true, .vertical = true}, NONE)) {
+        if (firstRow > 0) CLAY(spacerDeclaration(CLAY_SIZING_FIXED(1), topHeight)) {}
+        for (int32_t row = firstRow; row < lastRow; row++) {
+          virtualGridRow(&options, row, firstColumn, lastColumn);
+        }
+        if (lastRow < options.rowCount) CLAY(spacerDeclaration(CLAY_SIZING_FIXED(1), bottomHeight)) {}
+      }
     }
-    case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
-      EndScissorMode();
-      break;
+  }
+}
+
+static int32_t virtualTreeExpandedIndex(VirtualTreeState *state, uint32_t node) {
+  int32_t low = 0;
+  int32_t high = state->expandedCount;
+  while (low < high) {
+    int32_t middle = (low + high) / 2;
+    if (state->expandedNodes[middle] < node) low = middle + 1;
+    else high = middle;
+  }
+  return low;
+}
+
+static bool virtualTreeIsExpanded(VirtualTreeState *state, uint32_t node) {
+  int32_t index = virtualTreeExpandedIndex(state, node);
+  return index < state->expandedCount && state->expandedNodes[index] == node;
+}
+
+static void virtualTreeSetExpanded(VirtualTreeState *state, uint32_t node, bool expanded) {
+  int32_t index = virtualTreeExpandedIndex(state, node);
+  bool found = index < state->expandedCount && state->expandedNodes[index] == node;
+  if (expanded && !found) {
+    if (state->expandedCount == state->expandedCapacity) {
+      state->expandedCapacity = state->expandedCapacity ? state->expandedCapacity * 2 : 64;
+      state->expandedNodes = (uint32_t *)realloc(state->expandedNodes, sizeof(uint32_t) * state->expandedCapacity);
     }
-    case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
-      Clay_RectangleRenderData *config = &renderCommand->renderData.rectangle;
-      if (config->cornerRadius.topLeft > 0) {
-        float radius = (config->cornerRadius.topLeft * 2) / (float)((boundingBox.width > boundingBox.height) ? boundingBox.height : boundingBox.width);
-        DrawRectangleRounded((Rectangle){boundingBox.x, boundingBox.y, boundingBox.width, boundingBox.height}, radius, 8, CLAY_COLOR_TO_RAYLIB_COLOR(config->backgroundColor));
-      } else {
-        DrawRectangle(boundingBox.x, boundingBox.y, boundingBox.width, boundingBox.height, CLAY_COLOR_TO_RAYLIB_COLOR(config->backgroundColor));
-      }
+    memmove(&state->expandedNodes[index + 1], &state->expandedNodes[index], sizeof(uint32_t) * (state->expandedCount - index));
+    state->expandedNodes[index] = node;
+    state->expandedCount++;
+  } else if (!expanded && found) {
+    memmove(&state->expandedNodes[index], &state->expandedNodes[index + 1], sizeof(uint32_t) * (state->expandedCount - index - 1));
+    state->expandedCount--;
+  }
+}
+
+// Appends `node`'s children to the scratch rows, which go into the tree from row `base` on, with the subtrees of the
+// children that were expanded
+static void virtualTreeCollect(VirtualTreeState *state, uint32_t node, int32_t parent, int32_t base, uint16_t depth) {
+  int32_t childCount = state->childCount(node, state->userData);
+  for (int32_t i = 0; i < childCount; i++) {
+    uint32_t child = state->child(node, i, state->userData);
+    if (state->scratchCount == state->scratchCapacity) {
+      state->scratchCapacity = state->scratchCapacity ? state->scratchCapacity * 2 : 256;
+      state->scratch = (VirtualTreeNode *)realloc(state->scratch, sizeof(VirtualTreeNode) * state->scratchCapacity);
+    }
+    int32_t index = state->scratchCount++;
+    state->scratch[index] = (VirtualTreeNode){.node = child, .parent = parent, .depth = depth};
+    if (!virtualTreeIsExpanded(state, child)) continue;
+
+    virtualTreeCollect(state, child, base + index, base, depth + 1);
+    VirtualTreeNode *entry = &state->scratch[index];
+    entry->subtreeSize = state->scratchCount - index - 1;
+    entry->expanded = entry->subtreeSize > 0;
+    entry->hasChildren = entry->expanded;
+    entry->childrenCounted = true;
+  }
+}
+
+// Moves the scratch rows into the tree at `row`
+static void virtualTreeInsertScratch(VirtualTreeState *state, int32_t row) {
+  int32_t count = state->scratchCount;
+  if (count == 0) return;
+  if (state->count + count > state->capacity) {
+    int32_t capacity = state->capacity ? state->capacity : 256;
+    while (capacity < state->count + count) capacity *= 2;
+    state->nodes = (VirtualTreeNode *)realloc(state->nodes, sizeof(VirtualTreeNode) * capacity);
+    state->capacity = capacity;
+  }
+
+  // The rows after `row` move down, and so do the parents among them
+  for (int32_t i = row; i < state->count; i++) {
+    if (state->nodes[i].parent >= row) state->nodes[i].parent += count;
+  }
+  memmove(&state->nodes[row + count], &state->nodes[row], sizeof(VirtualTreeNode) * (state->count - row));
+  memcpy(&state->nodes[row], state->scratch, sizeof(VirtualTreeNode) * count);
+  state->count += count;
+  state->scratchCount = 0;
+}
+
+static void virtualTreeUpdateAncestors(VirtualTreeState *state, int32_t row, int32_t delta) {
+  for (int32_t i = state->nodes[row].parent; i >= 0; i = state->nodes[i].parent) state->nodes[i].subtreeSize += delta;
+}
+
+VirtualTreeState VirtualTreeInit(uint32_t root, VirtualTreeChildCountCallback childCount, VirtualTreeChildCallback child, void *userData) {
+  VirtualTreeState state = {.childCount = childCount, .child = child, .userData = userData};
+  virtualTreeCollect(&state, root, -1, 0, 0);
+  virtualTreeInsertScratch(&state, 0);
+  return state;
+}
+
+void VirtualTreeFree(VirtualTreeState *state) {
+  free(state->nodes);
+  free(state->expandedNodes);
+  free(state->scratch);
+  *state = (VirtualTreeState){0};
+}
+
+void VirtualTreeExpand(VirtualTreeState *state, int32_t row) {
+  if (row < 0 || row >= state->count) return;
+  VirtualTreeNode *node = &state->nodes[row];
+  if (node->expanded || (node->childrenCounted && !node->hasChildren)) return;
+
+  virtualTreeCollect(state, node->node, row, row + 1, node->depth + 1);
+  int32_t inserted = state->scratchCount;
+  node->hasChildren = inserted > 0;
+  node->childrenCounted = true;
+  if (inserted == 0) return;
+
+  node->expanded = true;
+  node->subtreeSize = inserted;
+  virtualTreeSetExpanded(state, node->node, true);
+  virtualTreeInsertScratch(state, row + 1);
+  virtualTreeUpdateAncestors(state, row, inserted);
+}
+
+void VirtualTreeCollapse(VirtualTreeState *state, int32_t row) {
+  if (row < 0 || row >= state->count) return;
+  VirtualTreeNode node = state->nodes[row];
+  if (!node.expanded) return;
+
+  // The descendants keep their entries in `expandedNodes` for the next expand
+  int32_t removed = (int32_t)node.subtreeSize;
+  memmove(&state->nodes[row + 1], &state->nodes[row + 1 + removed], sizeof(VirtualTreeNode) * (state->count - row - 1 - removed));
+  state->count -= removed;
+  for (int32_t i = row + 1; i < state->count; i++) {
+    if (state->nodes[i].parent > row) state->nodes[i].parent -= removed;
+  }
+  state->nodes[row].expanded = false;
+  state->nodes[row].subtreeSize = 0;
+  virtualTreeSetExpanded(state, node.node, false);
+  virtualTreeUpdateAncestors(state, row, -removed);
+}
+
+void VirtualTreeToggle(VirtualTreeState *state, int32_t row) {
+  if (row < 0 || row >= state->count) return;
+  if (state->nodes[row].expanded) VirtualTreeCollapse(state, row);
+  else VirtualTreeExpand(state, row);
+}
+
+static void virtualTreeRow(int32_t row, void *userData) {
+  VirtualTreeOptions *options = (VirtualTreeOptions *)userData;
+  VirtualTreeState *state = options->state;
+  VirtualTreeNode *node = &state->nodes[row];
+  if (!node->childrenCounted) {
+    node->hasChildren = state->childCount(node->node, state->userData) > 0;
+    node->childrenCounted = true;
+  }
+  options->onRow(node, row, options->userData);
+}
+
+void VirtualTreeDeclare(VirtualTreeOptions options) {
+  assert(options.state && "VirtualTree needs a state");
+  VirtualList(.id = options.id,
+              .w = options.w,
+              .h = options.h,
+              .bg = options.bg,
+              .rowCount = options.state->count,
+              .rowHeight = options.rowHeight,
+              .overscan = options.overscan,
+              .onRow = virtualTreeRow,
+              .userData = &options);
+}
+
+#define FILE_VIEW_READ_SIZE (1 << 20)
+
+static uint64_t fileViewSize(FileViewState *state) {
+#ifdef _WIN32
+  LARGE_INTEGER size;
+  return GetFileSizeEx(state->file, &size) ? (uint64_t)size.QuadPart : 0;
+#else
+  struct stat info;
+  return fstat(state->fd, &info) == 0 ? (uint64_t)info.st_size : 0;
+#endif
+}
+
+static int64_t fileViewRead(FileViewState *state, char *buffer, size_t size, uint64_t offset) {
+#ifdef _WIN32
+  OVERLAPPED overlapped = {.Offset = (DWORD)offset, .OffsetHigh = (DWORD)(offset >> 32)};
+  DWORD read = 0;
+  return ReadFile(state->file, buffer, (DWORD)size, &read, &overlapped) ? (int64_t)read : -1;
+#else
+  return pread(state->fd, buffer, size, (off_t)offset);
+#endif
+}
+
+static void fileViewUnmap(FileViewState *state) {
+  if (!state->data) return;
+#ifdef _WIN32
+  UnmapViewOfFile(state->data);
+  CloseHandle(state->mapping);
+#else
+  munmap((void *)state->data, state->mappedSize);
+#endif
+  state->data = NULL;
+  state->mappedSize = 0;
+}
+
+static void fileViewMap(FileViewState *state, uint64_t size) {
+  fileViewUnmap(state);
+  if (size == 0) return;
+#ifdef _WIN32
+  state->mapping = CreateFileMappingA(state->file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!state->mapping) return;
+  state->data = (const char *)MapViewOfFile(state->mapping, FILE_MAP_READ, 0, 0, (SIZE_T)size);
+  if (!state->data) CloseHandle(state->mapping);
+#else
+  void *data = mmap(NULL, size, PROT_READ, MAP_SHARED, state->fd, 0);
+  if (data == MAP_FAILED) return;
+  state->data = (const char *)data;
+#endif
+  if (state->data) state->mappedSize = size;
+}
+
+static bool fileViewPushLineStart(FileViewState *state, uint64_t start) {
+  size_t count = atomic_load_explicit(&state->lineStartCount, memory_order_relaxed);
+  size_t chunk = count / FILE_VIEW_CHUNK_LINES;
+  if (chunk >= FILE_VIEW_MAX_CHUNKS) return false;
+  if (!state->lineStarts[chunk]) state->lineStarts[chunk] = (uint64_t *)malloc(sizeof(uint64_t) * FILE_VIEW_CHUNK_LINES);
+
+  state->lineStarts[chunk][count % FILE_VIEW_CHUNK_LINES] = start;
+  atomic_store_explicit(&state->lineStartCount, count + 1, memory_order_release);
+  return true;
+}
+
+static void fileViewIndexer(void *arg) {
+  FileViewState *state = (FileViewState *)arg;
+  char *buffer = (char *)malloc(FILE_VIEW_READ_SIZE);
+  uint64_t indexed = 0;
+  fileViewPushLineStart(state, 0);
+
+  while (atomic_load(&state->running)) {
+    // Line starts past a truncation are wrong, the render thread resets the index and starts over
+    if (fileViewSize(state) < indexed) {
+      atomic_store(&state->shrunk, true);
       break;
     }
-    case CLAY_RENDER_COMMAND_TYPE_BORDER: {
-      Clay_BorderRenderData *config = &renderCommand->renderData.border;
-      // Left border
-      if (config->width.left > 0) {
-        DrawRectangle((int)roundf(boundingBox.x),
-                      (int)roundf(boundingBox.y + config->cornerRadius.topLeft),
-                      (int)config->width.left,
-                      (int)roundf(boundingBox.height - config->cornerRadius.topLeft - config->cornerRadius.bottomLeft),
-                      CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
-      }
-      // Right border
-      if (config->width.right > 0) {
-        DrawRectangle((int)roundf(boundingBox.x + boundingBox.width - config->width.right),
-                      (int)roundf(boundingBox.y + config->cornerRadius.topRight),
-                      (int)config->width.right,
-                      (int)roundf(boundingBox.height - config->cornerRadius.topRight - config->cornerRadius.bottomRight),
-                      CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
-      }
-      // Top border
-      if (config->width.top > 0) {
-        DrawRectangle((int)roundf(boundingBox.x + config->cornerRadius.topLeft),
-                      (int)roundf(boundingBox.y),
-                      (int)roundf(boundingBox.width - config->cornerRadius.topLeft - config->cornerRadius.topRight),
-                      (int)config->width.top,
-                      CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
-      }
-      // Bottom border
-      if (config->width.bottom > 0) {
-        DrawRectangle((int)roundf(boundingBox.x + config->cornerRadius.bottomLeft),
-                      (int)roundf(boundingBox.y + boundingBox.height - config->width.bottom),
-                      (int)roundf(boundingBox.width - config->cornerRadius.bottomLeft - config->cornerRadius.bottomRight),
-                      (int)config->width.bottom,
-                      CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
-      }
-      if (config->cornerRadius.topLeft > 0) {
-        DrawRing((Vector2){roundf(boundingBox.x + config->cornerRadius.topLeft), roundf(boundingBox.y + config->cornerRadius.topLeft)},
-                 roundf(config->cornerRadius.topLeft - config->width.top),
-                 config->cornerRadius.topLeft,
-                 180,
-                 270,
-                 10,
-                 CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
-      }
-      if (config->cornerRadius.topRight > 0) {
-        DrawRing((Vector2){roundf(boundingBox.x + boundingBox.width - config->cornerRadius.topRight), roundf(boundingBox.y + config->cornerRadius.topRight)},
-                 roundf(config->cornerRadius.topRight - config->width.top),
-                 config->cornerRadius.topRight,
-                 270,
-                 360,
-                 10,
-                 CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
-      }
-      if (config->cornerRadius.bottomLeft > 0) {
-        DrawRing((Vector2){roundf(boundingBox.x + config->cornerRadius.bottomLeft), roundf(boundingBox.y + boundingBox.height - config->cornerRadius.bottomLeft)},
-                 roundf(config->cornerRadius.bottomLeft - config->width.top),
-                 config->cornerRadius.bottomLeft,
-                 90,
-                 180,
-                 10,
-                 CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
-      }
-      if (config->cornerRadius.bottomRight > 0) {
-        DrawRing((Vector2){roundf(boundingBox.x + boundingBox.width - config->cornerRadius.bottomRight), roundf(boundingBox.y + boundingBox.height - config->cornerRadius.bottomRight)},
-                 roundf(config->cornerRadius.bottomRight - config->width.bottom),
-                 config->cornerRadius.bottomRight,
-                 0.1,
-                 90,
-                 10,
-                 CLAY_COLOR_TO_RAYLIB_COLOR(config->color));
+
+    int64_t read = fileViewRead(state, buffer, FILE_VIEW_READ_SIZE, indexed);
+    if (read <= 0) {
+      if (!state->tail) break;
+      RenderSleep(0.05);
+      continue;
+    }
+
+    const char *full = NULL;
+    for (const char *newline = buffer; (newline = (const char *)memchr(newline, '\n', buffer + read - newline)) != NULL; newline++) {
+      if (!fileViewPushLineStart(state, indexed + (newline - buffer) + 1)) {
+        full = newline;
+        break;
       }
+    }
+
+    if (full) {
+      // Out of chunks, the last line ends at the break instead of swallowing the rest of the file
+      atomic_store_explicit(&state->indexedSize, indexed + (full - buffer), memory_order_release);
+      atomic_store(&state->truncated, true);
+      LogWarn(LOG_CATEGORY_APP, "FileView stopped indexing after %zu lines", (size_t)FILE_VIEW_MAX_CHUNKS * FILE_VIEW_CHUNK_LINES);
       break;
     }
-    case CLAY_RENDER_COMMAND_TYPE_CUSTOM: {
-      Clay_CustomRenderData *config = &renderCommand->renderData.custom;
-      CustomLayoutElement *customElement = (CustomLayoutElement *)config->customData;
-      if (!customElement) continue;
-      switch (customElement->type) {
-      case CUSTOM_LAYOUT_ELEMENT_TYPE_3D_MODEL: {
-        Clay_BoundingBox rootBox = renderCommands.internalArray[0].boundingBox;
-        float scaleValue = CLAY__MIN(CLAY__MIN(1, 768 / rootBox.height) * CLAY__MAX(1, rootBox.width / 1024), 1.5f);
-        Ray positionRay = GetScreenToWorldPointWithZDistance((Vector2){renderCommand->boundingBox.x + renderCommand->boundingBox.width / 2, renderCommand->boundingBox.y + (renderCommand->boundingBox.height / 2) + 20},
-                                                             Raylib_camera,
-                                                             (int)roundf(rootBox.width),
-                                                             (int)roundf(rootBox.height),
-                                                             140);
-        BeginMode3D(Raylib_camera);
-        DrawModel(customElement->customData.model.model, positionRay.position, customElement->customData.model.scale * scaleValue, WHITE); // Draw 3d model with texture
-        EndMode3D();
-        break;
+    indexed += (uint64_t)read;
+    atomic_store_explicit(&state->indexedSize, indexed, memory_order_release);
+  }
+
+  free(buffer);
+}
+
+// Starts indexing from the beginning, the indexer must not be running
+static bool fileViewStartIndexer(FileViewState *state) {
+  atomic_store(&state->lineStartCount, 0);
+  atomic_store(&state->indexedSize, 0);
+  atomic_store(&state->shrunk, false);
+  atomic_store(&state->truncated, false);
+  atomic_store(&state->running, true);
+  state->indexing = RenderThreadStart(&state->indexer, fileViewIndexer, state);
+  return state->indexing;
+}
+
+static void fileViewStopIndexer(FileViewState *state) {
+  atomic_store(&state->running, false);
+  if (state->indexing) RenderThreadJoin(state->indexer);
+  state->indexing = false;
+}
+
+void FileViewClose(FileViewState *state);
+
+FileViewState *FileViewOpen(const char *path, bool tail) {
+  FileViewState *state = (FileViewState *)calloc(1, sizeof(FileViewState));
+#ifdef _WIN32
+  state->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (state->file == INVALID_HANDLE_VALUE) {
+#else
+  state->fd = open(path, O_RDONLY);
+  if (state->fd < 0) {
+#endif
+    free(state);
+    return NULL;
+  }
+
+  state->tail = tail;
+  state->following = tail;
+  state->lastSizeCheck = GetTime();
+  state->fileSize = fileViewSize(state);
+  fileViewMap(state, state->fileSize);
+  if (!fileViewStartIndexer(state)) {
+    FileViewClose(state);
+    return NULL;
+  }
+  return state;
+}
+
+void FileViewClose(FileViewState *state) {
+  fileViewStopIndexer(state);
+  fileViewUnmap(state);
+#ifdef _WIN32
+  CloseHandle(state->file);
+#else
+  close(state->fd);
+#endif
+  for (int32_t i = 0; i < FILE_VIEW_MAX_CHUNKS && state->lineStarts[i]; i++) {
+    free(state->lineStarts[i]);
+  }
+  free(state);
+}
+
+static uint64_t fileViewLineStart(FileViewState *state, size_t line) {
+  return state->lineStarts[line / FILE_VIEW_CHUNK_LINES][line % FILE_VIEW_CHUNK_LINES];
+}
+
+int32_t FileViewLineCount(FileViewState *state) {
+  size_t starts = atomic_load_explicit(&state->lineStartCount, memory_order_acquire);
+  uint64_t indexed = atomic_load_explicit(&state->indexedSize, memory_order_acquire);
+  if (starts == 0) return 0;
+
+  // The last start is only a line once something follows it
+  size_t lines = starts - 1 + (indexed > fileViewLineStart(state, starts - 1) ? 1 : 0);
+  return (int32_t)CLAY__MIN(lines, (size_t)INT32_MAX);
+}
+
+Clay_String FileViewLine(FileViewState *state, int32_t line) {
+  size_t starts = atomic_load_explicit(&state->lineStartCount, memory_order_acquire);
+  uint64_t indexed = atomic_load_explicit(&state->indexedSize, memory_order_acquire);
+  if (line < 0 || (size_t)line >= starts) return (Clay_String){0};
+
+  uint64_t start = fileViewLineStart(state, line);
+  uint64_t end = (size_t)line + 1 < starts ? fileViewLineStart(state, line + 1) - 1 : indexed;
+  if (end < start || end > state->mappedSize || end > state->fileSize) return (Clay_String){0};
+  if (end > start && state->data[end - 1] == '\r') end--;
+  return (Clay_String){.length = (int32_t)(end - start), .chars = state->data + start};
+}
+
+static void fileViewRow(int32_t row, void *userData) {
+  FileViewOptions *options = (FileViewOptions *)userData;
+  Clay_String line = FileViewLine(options->state, row);
+  line.length = CLAY__MIN(line.length, options->maxLineLength);
+  CLAY(spacerDeclaration(CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(options->rowHeight))) {
+    if (line.length > 0) Text(line, options->textConfig);
+  }
+}
+
+void FileViewDeclare(FileViewOptions options) {
+  FileViewState *state = options.state;
+  assert(state && "FileView needs a state from FileViewOpen");
+  if (!options.maxLineLength) options.maxLineLength = 2048;
+
+  // Remap before declaring anything, the previous frame's slices are already drawn. Pages past the end of a file that
+  // shrank fault when touched, so that remaps right away and indexing starts over
+  uint64_t indexed = atomic_load_explicit(&state->indexedSize, memory_order_acquire);
+  double now = GetTime();
+  state->fileSize = fileViewSize(state);
+  if (state->fileSize < indexed || atomic_load(&state->shrunk)) {
+    fileViewStopIndexer(state);
+    fileViewMap(state, state->fileSize);
+    state->lastSizeCheck = now;
+    if (!fileViewStartIndexer(state)) LogError(LOG_CATEGORY_APP, "FileView couldn't restart its indexer");
+  } else if (state->fileSize < state->mappedSize || (indexed > state->mappedSize && now - state->lastSizeCheck > 0.25)) {
+    fileViewMap(state, state->fileSize);
+    state->lastSizeCheck = now;
+  }
+
+  ScrollHandle handle = ScrollHandleGet(options.id);
+  if (state->tail && ScrollHandleResolve(&handle)) {
+    Clay_ScrollContainerData *data = &handle.data;
+    float bottom = -fmaxf(0, data->contentDimensions.height - data->scrollContainerDimensions.height);
+    // Following stops once the user scrolls up from where we last put it, and resumes back at the bottom
+    if (state->following) state->following = data->scrollPosition->y <= state->followedPosition + 1;
+    else state->following = data->scrollPosition->y <= bottom + 1;
+    if (state->following) data->scrollPosition->y = state->followedPosition = bottom;
+  }
+
+  VirtualList(.id = options.id,
+              .w = options.w,
+              .h = options.h,
+              .bg = options.bg,
+              .rowCount = FileViewLineCount(state),
+              .rowHeight = options.rowHeight,
+              .onRow = fileViewRow,
+              .userData = &options);
+}
+
+void RichTextDeclare(Clay_String text, TextSpan *spans, int32_t spanCount) {
+  // Render commands read the text and spans after the caller's buffers may be gone, so both go into the frame arena
+  CustomLayoutElement *element = (CustomLayoutElement *)ArenaAlloc(&renderer.frameArena, sizeof(CustomLayoutElement));
+  CustomLayoutElement_TextSpans *rich = &element->customData.textSpans;
+  element->type = CUSTOM_LAYOUT_ELEMENT_TYPE_TEXT_SPANS;
+  char *chars = (char *)ArenaAlloc(&renderer.frameArena, text.length);
+  if (text.length > 0) memcpy(chars, text.chars, text.length);
+  *rich = (CustomLayoutElement_TextSpans){
+      .chars = chars,
+      .length = text.length,
+      .spans = (TextSpan *)ArenaAlloc(&renderer.frameArena, sizeof(TextSpan) * spanCount),
+      .spanCount = spanCount,
+      .offsets = (float *)ArenaAlloc(&renderer.frameArena, sizeof(float) * spanCount),
+  };
+  memcpy(rich->spans, spans, sizeof(TextSpan) * spanCount);
+
+  float x = 0;
+  int32_t cursor = 0;
+  for (int32_t i = 0; i < spanCount; i++) {
+    TextSpan span = spans[i];
+    assert(span.start >= cursor && span.start + span.length <= text.length && "RichText spans must be in order and inside the text");
+    // Text skipped between spans still takes up space, measured in the next span's font
+    x += measureLineWidth(renderer.fonts, span.fontId, span.fontSize, text.chars + cursor, span.start - cursor);
+    rich->offsets[i] = x;
+    x += measureLineWidth(renderer.fonts, span.fontId, span.fontSize, text.chars + span.start, span.length);
+    rich->height = fmaxf(rich->height, span.fontSize);
+    cursor = span.start + span.length;
+  }
+
+  CLAY(customDeclaration(CLAY_SIZING_FIXED(x), CLAY_SIZING_FIXED(rich->height), element)) {}
+}
+
+float PreTextMeasure(Clay_String *lines, int32_t lineCount, uint16_t fontId, uint16_t fontSize) {
+  float width = 0;
+  for (int32_t i = 0; i < lineCount; i++) {
+    width = fmaxf(width, measureLineWidth(renderer.fonts, fontId, fontSize, lines[i].chars, lines[i].length));
+  }
+  return width;
+}
+
+// Widths measured by `PreTextDeclare`, keyed like FlameGraph's label widths. The least recently used one is replaced
+#define PRE_TEXT_WIDTH_CACHE_SIZE 32
+
+typedef struct {
+  const Clay_String *lines;
+  int32_t lineCount;
+  uint16_t fontId;
+  uint16_t fontSize;
+  float width;
+  uint64_t usedFrame;
+} PreTextWidth;
+
+static PreTextWidth preTextWidths[PRE_TEXT_WIDTH_CACHE_SIZE] = {0};
+
+static float preTextWidth(PreTextOptions *options) {
+  PreTextWidth *oldest = &preTextWidths[0];
+  for (int32_t i = 0; i < PRE_TEXT_WIDTH_CACHE_SIZE; i++) {
+    PreTextWidth *cached = &preTextWidths[i];
+    if (cached->lines == options->lines && cached->lineCount == options->lineCount && cached->fontId == options->fontId && cached->fontSize == options->fontSize) {
+      cached->usedFrame = renderer.frameIndex;
+      return cached->width;
+    }
+    if (cached->usedFrame < oldest->usedFrame) oldest = cached;
+  }
+
+  *oldest = (PreTextWidth){
+      .lines = options->lines,
+      .lineCount = options->lineCount,
+      .fontId = options->fontId,
+      .fontSize = options->fontSize,
+      .width = PreTextMeasure(options->lines, options->lineCount, options->fontId, options->fontSize),
+      .usedFrame = renderer.frameIndex,
+  };
+  return oldest->width;
+}
+
+void PreTextDeclare(PreTextOptions options) {
+  if (!options.lineHeight) options.lineHeight = options.fontSize;
+  if (!options.width) options.width = preTextWidth(&options);
+
+  CustomLayoutElement *element = (CustomLayoutElement *)ArenaAlloc(&renderer.frameArena, sizeof(CustomLayoutElement));
+  element->type = CUSTOM_LAYOUT_ELEMENT_TYPE_PRE_TEXT;
+  element->customData.preText = (CustomLayoutElement_PreText){
+      .lines = options.lines,
+      .lineCount = options.lineCount,
+      .color = options.color,
+      .fontId = options.fontId,
+      .fontSize = options.fontSize,
+      .lineHeight = options.lineHeight,
+  };
+  CLAY(customDeclaration(CLAY_SIZING_FIXED(options.width), CLAY_SIZING_FIXED(options.lineCount * options.lineHeight), element)) {}
+}
+
+static bool keyPressedOrRepeat(int key) {
+  return InputKeyPressed(key) || InputKeyPressedRepeat(key);
+}
+
+static void textInputReplaceSelection(TextInputState *state, const char *chars, int32_t count) {
+  int32_t start = CLAY__MIN(state->caret, state->anchor);
+  textInputDelete(state, start, CLAY__MAX(state->caret, state->anchor));
+  textInputInsert(state, start, chars, count);
+  state->caret = state->anchor = start + count;
+}
+
+static void textInputHandleKeys(TextInputState *state) {
+  bool shift = InputKeyDown(KEY_LEFT_SHIFT) || InputKeyDown(KEY_RIGHT_SHIFT);
+  bool control = InputKeyDown(KEY_LEFT_CONTROL) || InputKeyDown(KEY_RIGHT_CONTROL);
+  int32_t length = TextInputLength(state);
+  int32_t selectionStart = CLAY__MIN(state->caret, state->anchor);
+  int32_t selectionEnd = CLAY__MAX(state->caret, state->anchor);
+  int32_t caret = state->caret;
+
+  if (control && InputKeyPressed(KEY_A)) {
+    state->anchor = 0;
+    state->caret = length;
+    return;
+  }
+  if (control && (InputKeyPressed(KEY_C) || InputKeyPressed(KEY_X)) && selectionStart != selectionEnd) {
+    char *terminated = (char *)ArenaAlloc(&renderer.frameArena, selectionEnd - selectionStart + 1);
+    for (int32_t i = selectionStart; i < selectionEnd; i++) terminated[i - selectionStart] = textInputAt(state, i);
+    SetClipboardText(terminated);
+    if (InputKeyPressed(KEY_X)) textInputReplaceSelection(state, "", 0);
+    return;
+  }
+  if (control && InputKeyPressed(KEY_V)) {
+    const char *clipboard = GetClipboardText();
+    if (!clipboard) return;
+    // Only printable characters, the field is a single line
+    char *printable = (char *)ArenaAlloc(&renderer.frameArena, strlen(clipboard) + 1);
+    int32_t count = 0;
+    for (const char *c = clipboard; *c; c++) {
+      if (*c >= 32 && *c <= 126) printable[count++] = *c;
+    }
+    textInputReplaceSelection(state, printable, count);
+    return;
+  }
+
+  bool backspace = keyPressedOrRepeat(KEY_BACKSPACE);
+  if (backspace || keyPressedOrRepeat(KEY_DELETE)) {
+    if (selectionStart == selectionEnd) state->anchor = backspace ? CLAY__MAX(0, caret - 1) : CLAY__MIN(length, caret + 1);
+    textInputReplaceSelection(state, "", 0);
+    return;
+  }
+
+  if (keyPressedOrRepeat(KEY_LEFT)) caret = !shift && selectionStart != selectionEnd ? selectionStart : CLAY__MAX(0, caret - 1);
+  else if (keyPressedOrRepeat(KEY_RIGHT)) caret = !shift && selectionStart != selectionEnd ? selectionEnd : CLAY__MIN(length, caret + 1);
+  else if (InputKeyPressed(KEY_HOME)) caret = 0;
+  else if (InputKeyPressed(KEY_END)) caret = length;
+  else return;
+
+  state->caret = caret;
+  if (!shift) state->anchor = caret;
+}
+
+void TextInputDeclare(TextInputOptions options) {
+  TextInputState *state = options.state;
+  assert(options.id && state && "TextInput needs an id and a state from TextInputInit");
+  Clay_ElementId textId = Clay__HashString(toClayString(options.id), 1, 0);
+  Clay_BoundingBox textBox = Clay_GetElementData(textId).boundingBox;
+
+  // Pointer uses last frame's layout, like everything else reading Clay state before declaring
+  Vector2 mouse = InputMousePosition();
+  if (InputMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+    state->focused = Clay_PointerOver(Clay__HashString(toClayString(options.id), 0, 0));
+    state->selecting = state->focused;
+  }
+  if (!InputMouseButtonDown(MOUSE_BUTTON_LEFT)) state->selecting = false;
+  if (state->selecting) {
+    state->caret = textInputCaretAt(state, mouse.x - textBox.x + state->scrollX);
+    if (InputMouseButtonPressed(MOUSE_BUTTON_LEFT) && !InputKeyDown(KEY_LEFT_SHIFT) && !InputKeyDown(KEY_RIGHT_SHIFT)) state->anchor = state->caret;
+  }
+
+  if (state->focused) {
+    for (int codepoint = InputCharPressed(); codepoint > 0; codepoint = InputCharPressed()) {
+      if (codepoint < 32 || codepoint > 126) continue;
+      char c = (char)codepoint;
+      textInputReplaceSelection(state, &c, 1);
+    }
+    textInputHandleKeys(state);
+  }
+
+  // Keep the caret in view
+  float caretX = textInputAdvance(state, state->caret);
+  if (caretX < state->scrollX) state->scrollX = caretX;
+  else if (state->viewWidth > 0 && caretX > state->scrollX + state->viewWidth - 1) state->scrollX = caretX - state->viewWidth + 1;
+
+  CustomLayoutElement *element = (CustomLayoutElement *)ArenaAlloc(&renderer.frameArena, sizeof(CustomLayoutElement));
+  element->type = CUSTOM_LAYOUT_ELEMENT_TYPE_TEXT_INPUT;
+  element->customData.textInput = state;
+  Row(.id = options.id, .w = options.w ? options.w : "grow-0", .bg = options.bg, .px = 6, .py = 4) {
+    Clay_ElementDeclaration text = customDeclaration(CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(state->fontSize), element);
+    text.id = textId;
+    CLAY(text) {}
+  }
+}
+
+static void textEditorHandleInput(TextEditorState *state, Clay_BoundingBox textBox) {
+  int32_t caret = state->caret;
+  int32_t line = textEditorLineAt(state, caret);
+  int32_t lineStart = textEditorLineStart(state, line);
+
+  if (InputMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+    Vector2 mouse = InputMousePosition();
+    int32_t row = CLAY__MAX(0, (int32_t)((mouse.y - textBox.y) / state->lineHeight));
+    int32_t clicked = textEditorLineAtRow(state, row);
+    int32_t rowStart;
+    int32_t targetRow = row - textEditorLineRow(state, clicked);
+    int32_t slot = textEditorSlot(state, clicked);
+    int32_t rows = state->lineRows[slot];
+    int32_t *breaks = state->lineBreaks[slot];
+    int32_t clickedStart = textEditorLineStart(state, clicked);
+    targetRow = CLAY__MIN(targetRow, rows - 1);
+    rowStart = targetRow > 0 ? breaks[targetRow - 1] : 0;
+    int32_t rowEnd = targetRow + 1 < rows ? breaks[targetRow] : textEditorLineEnd(state, clicked) - clickedStart;
+    char *chars = textEditorText(state, clickedStart + rowStart, rowEnd - rowStart);
+
+    float x = textBox.x;
+    int32_t i = 0;
+    for (; i < rowEnd - rowStart; i++) {
+      float width = textEditorCharWidth(state, chars[i]);
+      if (x + width / 2 > mouse.x) break;
+      x += width;
+    }
+    state->caret = clickedStart + rowStart + i;
+    return;
+  }
+
+  for (int codepoint = InputCharPressed(); codepoint > 0; codepoint = InputCharPressed()) {
+    if (codepoint < 32 || codepoint > 126) continue;
+    char c = (char)codepoint;
+    TextEditorReplace(state, caret, 0, &c, 1);
+    caret++;
+  }
+
+  if (keyPressedOrRepeat(KEY_ENTER)) TextEditorReplace(state, caret++, 0, "\n", 1);
+  else if (keyPressedOrRepeat(KEY_TAB)) TextEditorReplace(state, caret++, 0, "\t", 1);
+  else if (keyPressedOrRepeat(KEY_BACKSPACE) && caret > 0) TextEditorReplace(state, --caret, 1, NULL, 0);
+  else if (keyPressedOrRepeat(KEY_DELETE) && caret < state->length) TextEditorReplace(state, caret, 1, NULL, 0);
+  else if (keyPressedOrRepeat(KEY_LEFT)) caret = CLAY__MAX(0, caret - 1);
+  else if (keyPressedOrRepeat(KEY_RIGHT)) caret = CLAY__MIN(state->length, caret + 1);
+  else if (InputKeyPressed(KEY_HOME)) caret = lineStart;
+  else if (InputKeyPressed(KEY_END)) caret = textEditorLineEnd(state, line);
+  else if (keyPressedOrRepeat(KEY_UP) && line > 0) caret = CLAY__MIN(textEditorLineStart(state, line - 1) + caret - lineStart, textEditorLineEnd(state, line - 1));
+  else if (keyPressedOrRepeat(KEY_DOWN) && line + 1 < state->lineCount) caret = CLAY__MIN(textEditorLineStart(state, line + 1) + caret - lineStart, textEditorLineEnd(state, line + 1));
+
+  if (caret != state->caret) state->caretMoved = true;
+  state->caret = caret;
+}
+
+void TextEditorDeclare(TextEditorOptions options) {
+  TextEditorState *state = options.state;
+  assert(options.id && state && "TextEditor needs an id and a state from TextEditorInit");
+  if (state->charWidths[' '] == 0) textEditorMeasureChars(state);
+
+  Clay_ElementId textId = Clay__HashString(toClayString(options.id), 1, 0);
+  Clay_BoundingBox textBox = Clay_GetElementData(textId).boundingBox;
+  if (InputMouseButtonPressed(MOUSE_BUTTON_LEFT)) state->focused = Clay_PointerOver(Clay__HashString(toClayString(options.id), 0, 0));
+  if (state->focused) textEditorHandleInput(state, textBox);
+
+  // A new width makes every line stale, but only lines that get scrolled into view are re-wrapped
+  if (state->viewWidth > 0 && state->viewWidth != state->wrapWidth) {
+    state->wrapWidth = state->viewWidth;
+    state->wrapGeneration++;
+  }
+
+  ScrollHandle handle = ScrollHandleGet(options.id);
+  float scrollY = 0;
+  float viewportHeight = (float)InputScreenHeight();
+  if (ScrollHandleResolve(&handle)) {
+    scrollY = -handle.data.scrollPosition->y;
+    viewportHeight = handle.data.scrollContainerDimensions.height;
+  }
+
+  int32_t line = textEditorLineAtRow(state, (int32_t)(scrollY / state->lineHeight));
+  for (; line < state->lineCount && textEditorLineRow(state, line) * state->lineHeight < scrollY + viewportHeight; line++) {
+    if (state->lineWrapped[textEditorSlot(state, line)] != state->wrapGeneration) textEditorRewrap(state, line);
+  }
+
+  if (state->caretMoved && handle.data.found) {
+    int32_t caretLine = textEditorLineAt(state, state->caret);
+    if (state->lineWrapped[textEditorSlot(state, caretLine)] != state->wrapGeneration) textEditorRewrap(state, caretLine);
+    int32_t rowStart;
+    float caretY = (textEditorLineRow(state, caretLine) + textEditorRowOf(state, caretLine, state->caret, &rowStart)) * state->lineHeight;
+    if (caretY < scrollY) handle.data.scrollPosition->y = -caretY;
+    else if (caretY + state->lineHeight > scrollY + viewportHeight) handle.data.scrollPosition->y = -(caretY + state->lineHeight - viewportHeight);
+    state->caretMoved = false;
+  }
+
+  CustomLayoutElement *element = (CustomLayoutElement *)ArenaAlloc(&renderer.frameArena, sizeof(CustomLayoutElement));
+  element->type = CUSTOM_LAYOUT_ELEMENT_TYPE_TEXT_EDITOR;
+  element->customData.textEditor = state;
+  float height = fenwickPrefix(state->rowTree, state->lineCapacity) * state->lineHeight;
+  Column(.id = options.id, .scroll = "v", .w = options.w, .h = options.h, .bg = options.bg, .p = 6) {
+    Clay_ElementDeclaration text = customDeclaration(CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(height), element);
+    text.id = textId;
+    CLAY(text) {}
+  }
+}
+
+Vector2 CanvasSize(char *id) {
+  Clay_ElementData data = Clay_GetElementData(Clay__HashString(toClayString(id), 0, 0));
+  return data.found ? (Vector2){data.boundingBox.width, data.boundingBox.height} : (Vector2){0};
+}
+
+void DynamicTextureDeclare(DynamicTextureOptions options) {
+  assert(options.texture && "DynamicTexture needs a texture from DynamicTextureInit");
+  CustomLayoutElement *element = (CustomLayoutElement *)ArenaAlloc(&renderer.frameArena, sizeof(CustomLayoutElement));
+  element->type = CUSTOM_LAYOUT_ELEMENT_TYPE_DYNAMIC_TEXTURE;
+  element->customData.dynamicTexture = options.texture;
+  Clay_ElementDeclaration declaration = ParseComponentOptions(COMPONENT_OPTIONS(.id = options.id, .w = options.w, .h = options.h, .bg = options.bg), boxDefaultOptions);
+  declaration.custom.customData = element;
+  CLAY(declaration) {}
+}
+
+void CanvasDeclare(CanvasOptions options) {
+  CustomLayoutElement *element = (CustomLayoutElement *)ArenaAlloc(&renderer.frameArena, sizeof(CustomLayoutElement));
+  element->type = CUSTOM_LAYOUT_ELEMENT_TYPE_CANVAS;
+  element->customData.canvas = options.batch;
+  Clay_ElementDeclaration declaration = ParseComponentOptions(COMPONENT_OPTIONS(.id = options.id, .w = options.w, .h = options.h, .bg = options.bg), boxDefaultOptions);
+  declaration.custom.customData = element;
+  CLAY(declaration) {}
+}
+
+static void minMaxRange(const float *values, int64_t count, float *min, float *max) {
+  int64_t i = 0;
+  float low = values[0];
+  float high = values[0];
+#ifdef RENDERER_SSE2
+  if (count >= 8) {
+    __m128 lows = _mm_loadu_ps(values);
+    __m128 highs = lows;
+    for (i = 4; i + 4 <= count; i += 4) {
+      __m128 chunk = _mm_loadu_ps(values + i);
+      lows = _mm_min_ps(lows, chunk);
+      highs = _mm_max_ps(highs, chunk);
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, lows);
+    low = fminf(fminf(lanes[0], lanes[1]), fminf(lanes[2], lanes[3]));
+    _mm_storeu_ps(lanes, highs);
+    high = fmaxf(fmaxf(lanes[0], lanes[1]), fmaxf(lanes[2], lanes[3]));
+  }
+#endif
+  for (; i < count; i++) {
+    low = fminf(low, values[i]);
+    high = fmaxf(high, values[i]);
+  }
+  *min = low;
+  *max = high;
+}
+
+static double sumRange(const float *values, int64_t count) {
+  int64_t i = 0;
+  double sum = 0;
+#ifdef RENDERER_SSE2
+  // Summed in float lanes per block of 4096 so precision holds over millions of samples
+  for (; i + 4 <= count;) {
+    __m128 sums = _mm_setzero_ps();
+    int64_t end = i + CLAY__MIN(4096, (count - i) & ~(int64_t)3);
+    for (; i < end; i += 4) sums = _mm_add_ps(sums, _mm_loadu_ps(values + i));
+    float lanes[4];
+    _mm_storeu_ps(lanes, sums);
+    sum += (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+#endif
+  for (; i < count; i++) sum += values[i];
+  return sum;
+}
+
+void DecimateMinMax(const float *values, int64_t count, int32_t columns, float *mins, float *maxs) {
+  for (int32_t column = 0; column < columns; column++) {
+    int64_t start = count * column / columns;
+    int64_t end = CLAY__MAX(start + 1, count * (column + 1) / columns);
+    minMaxRange(values + start, CLAY__MIN(end, count) - start, &mins[column], &maxs[column]);
+  }
+}
+
+int32_t DecimateLttb(const float *values, int64_t count, int32_t threshold, int64_t *indices, float *picked) {
+  if (threshold >= count || threshold < 3) {
+    int32_t written = (int32_t)CLAY__MIN(count, (int64_t)threshold);
+    for (int32_t i = 0; i < written; i++) {
+      indices[i] = i;
+      picked[i] = values[i];
+    }
+    return written;
+  }
+
+  // First and last are kept, the rest is split in `threshold - 2` buckets that each keep the sample making the biggest
+  // triangle with the last kept sample and the average of the next bucket
+  double bucketSize = (double)(count - 2) / (threshold - 2);
+  int64_t previous = 0;
+  indices[0] = 0;
+  picked[0] = values[0];
+  for (int32_t bucket = 0; bucket < threshold - 2; bucket++) {
+    int64_t start = (int64_t)(bucket * bucketSize) + 1;
+    int64_t end = (int64_t)((bucket + 1) * bucketSize) + 1;
+    int64_t nextStart = end;
+    int64_t nextEnd = CLAY__MIN((int64_t)((bucket + 2) * bucketSize) + 1, count);
+    double averageX = (nextStart + nextEnd - 1) / 2.0;
+    double averageY = sumRange(values + nextStart, nextEnd - nextStart) / (double)(nextEnd - nextStart);
+
+    double bestArea = -1;
+    int64_t best = start;
+    for (int64_t i = start; i < end; i++) {
+      double area = fabs((previous - averageX) * (values[i] - values[previous]) - (previous - i) * (averageY - values[previous]));
+      if (area > bestArea) {
+        bestArea = area;
+        best = i;
       }
-      default:
-        break;
+    }
+    indices[bucket + 1] = best;
+    picked[bucket + 1] = values[best];
+    previous = best;
+  }
+  indices[threshold - 1] = count - 1;
+  picked[threshold - 1] = values[count - 1];
+  return threshold;
+}
+
+void SeriesInit(SeriesStore *store, int64_t capacity) {
+  *store = (SeriesStore){.capacity = 8};
+  while (store->capacity < capacity) store->capacity *= 2;
+  store->samples = (float *)malloc(sizeof(float) * store->capacity);
+  store->levelCount = 1;
+  while (store->levelCount < SERIES_MAX_LEVELS && (store->capacity >> (store->levelCount * SERIES_FANOUT_BITS)) > 0) {
+    store->levels[store->levelCount] = (SeriesBucket *)malloc(sizeof(SeriesBucket) * (store->capacity >> (store->levelCount * SERIES_FANOUT_BITS)));
+    store->levelCount++;
+  }
+}
+
+void SeriesFree(SeriesStore *store) {
+  free(store->samples);
+  for (int32_t level = 1; level < store->levelCount; level++) free(store->levels[level]);
+  *store = (SeriesStore){0};
+}
+
+void SeriesAppend(SeriesStore *store, float *values, int64_t count) {
+  for (int64_t i = 0; i < count; i++) {
+    int64_t index = store->count++;
+    float value = values[i];
+    store->samples[index & (store->capacity - 1)] = value;
+
+    // The first sample of a bucket resets it, the rest merge into it
+    for (int32_t level = 1; level < store->levelCount; level++) {
+      int32_t shift = level * SERIES_FANOUT_BITS;
+      SeriesBucket *bucket = &store->levels[level][(index >> shift) & ((store->capacity >> shift) - 1)];
+      if ((index & ((1LL << shift) - 1)) == 0) {
+        *bucket = (SeriesBucket){value, value, value};
+      } else {
+        bucket->min = fminf(bucket->min, value);
+        bucket->max = fmaxf(bucket->max, value);
+        bucket->sum += value;
       }
-      break;
     }
-    default: {
-      printf("Error: unhandled render command.");
-      exit(1);
+  }
+}
+
+int64_t SeriesFirst(SeriesStore *store) {
+  return CLAY__MAX(0, store->count - store->capacity);
+}
+
+// Min, max and sum of `[from, to)`, walking up to the widest aligned bucket that fits at each step
+static SeriesBucket seriesRange(SeriesStore *store, int64_t from, int64_t to) {
+  SeriesBucket result = {INFINITY, -INFINITY, 0};
+  for (int64_t position = from; position < to;) {
+    int32_t level = 0;
+    while (level + 1 < store->levelCount) {
+      int64_t size = 1LL << ((level + 1) * SERIES_FANOUT_BITS);
+      if ((position & (size - 1)) != 0 || position + size > to) break;
+      level++;
     }
+
+    SeriesBucket bucket;
+    if (level == 0) {
+      float value = store->samples[position & (store->capacity - 1)];
+      bucket = (SeriesBucket){value, value, value};
+    } else {
+      int32_t shift = level * SERIES_FANOUT_BITS;
+      bucket = store->levels[level][(position >> shift) & ((store->capacity >> shift) - 1)];
     }
+    result.min = fminf(result.min, bucket.min);
+    result.max = fmaxf(result.max, bucket.max);
+    result.sum += bucket.sum;
+    position += 1LL << (level * SERIES_FANOUT_BITS);
   }
+  return result;
 }
 
-Clay_String toClayString(char *str) {
-  return (Clay_String){.length = strlen(str), .chars = str};
+void SeriesQuery(SeriesStore *store, int64_t from, int64_t to, int32_t columns, float *mins, float *maxs, float *means) {
+  from = CLAY__MAX(from, SeriesFirst(store));
+  to = CLAY__MIN(to, store->count);
+  for (int32_t column = 0; column < columns; column++) {
+    int64_t start = from + (to - from) * column / columns;
+    int64_t end = CLAY__MAX(start + 1, from + (to - from) * (column + 1) / columns);
+    end = CLAY__MIN(end, to);
+    SeriesBucket bucket = start < end ? seriesRange(store, start, end) : (SeriesBucket){0};
+    mins[column] = bucket.min;
+    maxs[column] = bucket.max;
+    if (means) means[column] = start < end ? (float)(bucket.sum / (end - start)) : 0;
+  }
 }
 
-/* Our renderer.h specifics */
-Renderer renderer = {0};
-void HandleClayErrors(Clay_ErrorData errorData) {
-  printf("%s", errorData.errorText.chars);
-
-  if (errorData.errorType == CLAY_ERROR_TYPE_ELEMENTS_CAPACITY_EXCEEDED) {
-    renderer.reinitialize = true;
-    Clay_SetMaxElementCount(Clay_GetMaxElementCount() * 2);
+void LineChartDeclare(LineChartOptions options) {
+  assert(options.id && "LineChart needs an id to know its size");
+  Vector2 size = CanvasSize(options.id);
+  int32_t columns = (int32_t)size.x;
+  if (options.series) {
+    options.to = options.to ? CLAY__MIN(options.to, options.series->count) : options.series->count;
+    options.from = CLAY__MAX(options.from, SeriesFirst(options.series));
+    options.count = options.to - options.from;
+  }
+  if (columns < 2 || options.count < 2) {
+    Canvas(.id = options.id, .w = options.w, .h = options.h, .bg = options.bg);
     return;
   }
 
-  if (errorData.errorType == CLAY_ERROR_TYPE_TEXT_MEASUREMENT_CAPACITY_EXCEEDED) {
-    renderer.reinitialize = true;
-    Clay_SetMaxMeasureTextCacheWordCount(Clay_GetMaxMeasureTextCacheWordCount() * 2);
-    return;
+  // About 2 points per pixel column, or every sample when there are fewer
+  int32_t pointCount = (int32_t)CLAY__MIN(options.count, (int64_t)columns * 2);
+  float *xs = (float *)ArenaAlloc(&renderer.frameArena, sizeof(float) * pointCount);
+  float *ys = (float *)ArenaAlloc(&renderer.frameArena, sizeof(float) * pointCount);
+  if (options.series && pointCount == options.count) {
+    // Few enough samples to show them all, one column each
+    float *mins = (float *)ArenaAlloc(&renderer.frameArena, sizeof(float) * pointCount);
+    SeriesQuery(options.series, options.from, options.to, pointCount, mins, ys, NULL);
+    for (int32_t i = 0; i < pointCount; i++) xs[i] = (float)i / (options.count - 1);
+  } else if (pointCount == options.count) {
+    for (int32_t i = 0; i < pointCount; i++) {
+      xs[i] = (float)i / (options.count - 1);
+      ys[i] = options.values[i];
+    }
+  } else if (options.decimation == LINE_CHART_LTTB && !options.series) {
+    int64_t *indices = (int64_t *)ArenaAlloc(&renderer.frameArena, sizeof(int64_t) * pointCount);
+    pointCount = DecimateLttb(options.values, options.count, pointCount, indices, ys);
+    for (int32_t i = 0; i < pointCount; i++) xs[i] = (float)indices[i] / (options.count - 1);
+  } else {
+    float *mins = (float *)ArenaAlloc(&renderer.frameArena, sizeof(float) * columns);
+    float *maxs = (float *)ArenaAlloc(&renderer.frameArena, sizeof(float) * columns);
+    if (options.series) SeriesQuery(options.series, options.from, options.to, columns, mins, maxs, NULL);
+    else DecimateMinMax(options.values, options.count, columns, mins, maxs);
+    // Alternating the order keeps the polyline a zigzag through each column's envelope
+    for (int32_t column = 0; column < columns; column++) {
+      xs[column * 2] = xs[column * 2 + 1] = (column + 0.5f) / columns;
+      ys[column * 2] = column % 2 ? maxs[column] : mins[column];
+      ys[column * 2 + 1] = column % 2 ? mins[column] : maxs[column];
+    }
+  }
+
+  float min = options.min;
+  float max = options.max;
+  if (min == 0 && max == 0) minMaxRange(ys, pointCount, &min, &max);
+  float scale = max > min ? (size.y - 1) / (max - min) : 0;
+
+  CanvasBatch *batch = CanvasBatchAlloc(CANVAS_LINES, pointCount, 2 * (pointCount - 1));
+  for (int32_t i = 0; i < pointCount; i++) {
+    CanvasVertex vertex = {xs[i] * (size.x - 1), (size.y - 1) - (ys[i] - min) * scale, options.color};
+    uint32_t index = CanvasVertices(batch, &vertex, 1);
+    if (i > 0) CanvasIndices(batch, (uint32_t[]){index - 1, index}, 2);
   }
+  Canvas(.id = options.id, .w = options.w, .h = options.h, .bg = options.bg, .batch = batch);
 }
 
-static void initDraw() {
-  if (IsKeyPressed(KEY_F2)) {
-    renderer.debugEnabled = !renderer.debugEnabled;
-    Clay_SetDebugModeEnabled(renderer.debugEnabled);
+void SparklineDeclare(SparklineOptions options) {
+  CustomLayoutElement *element = (CustomLayoutElement *)ArenaAlloc(&renderer.frameArena, sizeof(CustomLayoutElement));
+  element->type = CUSTOM_LAYOUT_ELEMENT_TYPE_SPARKLINE;
+  if (options.min == 0 && options.max == 0 && options.count > 0) minMaxRange(options.values, options.count, &options.min, &options.max);
+  // A flat line sits in the middle
+  if (options.max <= options.min) {
+    options.min -= 1;
+    options.max += 1;
+  }
+  element->customData.sparkline = (CustomLayoutElement_Sparkline){
+      .values = options.values, .count = options.count, .min = options.min, .max = options.max, .color = options.color};
+  Clay_ElementDeclaration declaration = ParseComponentOptions(COMPONENT_OPTIONS(.id = options.id, .w = options.w, .h = options.h, .bg = options.bg), boxDefaultOptions);
+  declaration.custom.customData = element;
+  CLAY(declaration) {}
+}
+
+typedef struct {
+  ScatterOptions *options;
+  int64_t chunk;
+  int64_t *visible;
+} ScatterJob;
+
+static void scatterBin(int32_t task, void *arg) {
+  ScatterJob *job = (ScatterJob *)arg;
+  ScatterOptions *options = job->options;
+  ScatterState *state = options->state;
+  float scaleX = state->texture.width / (options->maxX - options->minX);
+  float scaleY = state->texture.height / (options->maxY - options->minY);
+  int64_t end = CLAY__MIN(options->count, (task + 1) * job->chunk);
+  int64_t visible = 0;
+
+  for (int64_t i = task * job->chunk; i < end; i++) {
+    float x = (options->xs[i] - options->minX) * scaleX;
+    float y = (options->maxY - options->ys[i]) * scaleY;
+    if (!(x >= 0 && x < state->texture.width && y >= 0 && y < state->texture.height)) continue;
+    atomic_fetch_add_explicit(&state->grid[(int32_t)y * state->texture.width + (int32_t)x], 1, memory_order_relaxed);
+    visible++;
   }
+  job->visible[task] = visible;
+}
 
-  Clay_Vector2 mousePosition = RAYLIB_VECTOR2_TO_CLAY_VECTOR2(GetMousePosition());
-  Clay_SetPointerState(mousePosition, IsMouseButtonDown(0));
-  Clay_SetLayoutDimensions((Clay_Dimensions){(float)GetScreenWidth(), (float)GetScreenHeight()});
+static const Color *scatterDefaultPalette(void) {
+  static Color palette[256];
+  static const Color stops[] = {{20, 30, 90, 255}, {30, 120, 200, 255}, {90, 220, 210, 255}, {250, 230, 90, 255}, {255, 255, 255, 255}};
+  if (palette[255].a) return palette;
+  for (int32_t i = 0; i < 256; i++) {
+    float t = i / 255.0f * 4;
+    int32_t stop = CLAY__MIN((int32_t)t, 3);
+    Color from = stops[stop];
+    Color to = stops[stop + 1];
+    float f = t - stop;
+    palette[i] = (Color){(uint8_t)(from.r + (to.r - from.r) * f), (uint8_t)(from.g + (to.g - from.g) * f), (uint8_t)(from.b + (to.b - from.b) * f), 255};
+  }
+  return palette;
+}
 
-  Vector2 mouseWheelDelta = GetMouseWheelMoveV();
-  float mouseWheelX = mouseWheelDelta.x;
-  float mouseWheelY = mouseWheelDelta.y;
-  Clay_UpdateScrollContainers(true, (Clay_Vector2){mouseWheelX, mouseWheelY}, GetFrameTime());
+static void scatterResize(ScatterState *state, int32_t width, int32_t height) {
+  if (state->texture.width == width && state->texture.height == height) return;
+  ScatterFree(state);
+  state->grid = (atomic_uint *)malloc(sizeof(atomic_uint) * width * height);
+  DynamicTextureInit(&state->texture, width, height);
 }
 
-void ScrollContainerByY(char *containerName, float deltaY) {
-  Clay_ScrollContainerData scrollContainerData = Clay_GetScrollContainerData(Clay__HashString(toClayString(containerName), 0, 0));
-  float newScrollY = scrollContainerData.scrollPosition->y + deltaY;
-  float minScrollY = -fmaxf(0, scrollContainerData.contentDimensions.height - scrollContainerData.scrollContainerDimensions.height);
-  float newValue = fminf(0, fmaxf(newScrollY, minScrollY));
-  if (newValue == 0) {
-    printf("New value is higher min value\n");
-    printf("deltaY: %f, minPos: %f, newPos: %f", deltaY, minScrollY, fminf(0, fmaxf(newScrollY, minScrollY)));
+void ScatterFree(ScatterState *state) {
+  DynamicTextureFree(&state->texture);
+  free(state->grid);
+  *state = (ScatterState){0};
+}
+
+void ScatterDeclare(ScatterOptions options) {
+  assert(options.id && options.state && "Scatter needs an id and a state");
+  ScatterState *state = options.state;
+  if (!options.pointThreshold) options.pointThreshold = 20000;
+  if (!options.palette) options.palette = scatterDefaultPalette();
+  if (options.minX == options.maxX && options.minY == options.maxY && options.count > 0) {
+    minMaxRange(options.xs, options.count, &options.minX, &options.maxX);
+    minMaxRange(options.ys, options.count, &options.minY, &options.maxY);
+    // Points on the max edge still land in the last pixel
+    options.maxX = nextafterf(options.maxX, INFINITY);
+    options.minY = nextafterf(options.minY, -INFINITY);
+  }
+
+  Vector2 size = CanvasSize(options.id);
+  if (size.x < 1 || size.y < 1 || options.maxX <= options.minX || options.maxY <= options.minY) {
+    Canvas(.id = options.id, .w = options.w, .h = options.h, .bg = options.bg);
+    return;
+  }
+
+  scatterResize(state, (int32_t)size.x, (int32_t)size.y);
+  memset(state->grid, 0, sizeof(atomic_uint) * state->texture.width * state->texture.height);
+  // Chunks of at least 64K points, a few per core so uneven ones balance out
+  int32_t tasks = (int32_t)CLAY__MAX(1, CLAY__MIN((int64_t)RenderCoreCount() * 4, options.count / 65536));
+  ScatterJob job = {.options = &options, .chunk = (options.count + tasks - 1) / tasks};
+  job.visible = (int64_t *)ArenaAlloc(&renderer.frameArena, sizeof(int64_t) * tasks);
+  RenderParallelFor(tasks, scatterBin, &job);
+
+  int64_t visible = 0;
+  for (int32_t i = 0; i < tasks; i++) visible += job.visible[i];
+  if (visible <= options.pointThreshold) {
+    // Same mapping as the binning so exactly the counted points come through
+    float scaleX = state->texture.width / (options.maxX - options.minX);
+    float scaleY = state->texture.height / (options.maxY - options.minY);
+    CanvasBatch *batch = CanvasBatchAlloc(CANVAS_POINTS, (int32_t)visible, 0);
+    for (int64_t i = 0; i < options.count && batch->vertexCount < visible; i++) {
+      float x = (options.xs[i] - options.minX) * scaleX;
+      float y = (options.maxY - options.ys[i]) * scaleY;
+      if (x >= 0 && x < state->texture.width && y >= 0 && y < state->texture.height) CanvasPoint(batch, x, y, options.color);
+    }
+    Canvas(.id = options.id, .w = options.w, .h = options.h, .bg = options.bg, .batch = batch);
+    return;
+  }
+
+  // Log scale so sparse areas don't disappear next to the densest pixel
+  uint32_t maxCount = 1;
+  int32_t cells = state->texture.width * state->texture.height;
+  for (int32_t i = 0; i < cells; i++) maxCount = CLAY__MAX(maxCount, atomic_load_explicit(&state->grid[i], memory_order_relaxed));
+  float scale = 255 / logf(1.0f + maxCount);
+  for (int32_t i = 0; i < cells; i++) {
+    uint32_t count = atomic_load_explicit(&state->grid[i], memory_order_relaxed);
+    state->texture.pixels[i] = count ? options.palette[(int32_t)(logf(1.0f + count) * scale)] : BLANK;
   }
-  scrollContainerData.scrollPosition->y = newValue;
+  DynamicTextureMarkDirty(&state->texture, 0, 0, state->texture.width, state->texture.height);
+  DynamicTextureElement(.id = options.id, .w = options.w, .h = options.h, .bg = options.bg, .texture = &state->texture);
 }
 
-void ScrollContainerTop(char *containerName) {
-  Clay_ScrollContainerData scrollContainerData = Clay_GetScrollContainerData(Clay__HashString(toClayString(containerName), 0, 0));
-  scrollContainerData.scrollPosition->y = 0;
+/* Flame graph */
+// Sorted on its own instead of through the nodes, so `qsort` needs no context
+typedef struct {
+  int32_t depth;
+  int32_t node;
+  double start;
+} FlameSortKey;
+
+static int flameCompare(const void *a, const void *b) {
+  const FlameSortKey *x = (const FlameSortKey *)a;
+  const FlameSortKey *y = (const FlameSortKey *)b;
+  if (x->depth != y->depth) return x->depth < y->depth ? -1 : 1;
+  return x->start < y->start ? -1 : x->start > y->start ? 1 : 0;
 }
 
-void ScrollContainerBottom(char *containerName) {
-  Clay_ScrollContainerData scrollContainerData = Clay_GetScrollContainerData(Clay__HashString(toClayString(containerName), 0, 0));
-  float minScrollY = -fmaxf(0, scrollContainerData.contentDimensions.height - scrollContainerData.scrollContainerDimensions.height);
-  scrollContainerData.scrollPosition->y = minScrollY;
+void FlameGraphInit(FlameGraphState *state, const FlameNode *nodes, int32_t count) {
+  *state = (FlameGraphState){.nodes = nodes, .count = count, .minStart = INFINITY, .maxEnd = -INFINITY};
+  state->order = (int32_t *)malloc(sizeof(int32_t) * CLAY__MAX(count, 1));
+  state->starts = (double *)malloc(sizeof(double) * CLAY__MAX(count, 1));
+  state->ends = (double *)malloc(sizeof(double) * CLAY__MAX(count, 1));
+  FlameSortKey *keys = (FlameSortKey *)malloc(sizeof(FlameSortKey) * CLAY__MAX(count, 1));
+  for (int32_t i = 0; i < count; i++) {
+    assert(nodes[i].depth >= 0 && "FlameNode depth can't be negative");
+    keys[i] = (FlameSortKey){.depth = nodes[i].depth, .node = i, .start = nodes[i].start};
+    state->depthCount = CLAY__MAX(state->depthCount, nodes[i].depth + 1);
+    state->minStart = fmin(state->minStart, nodes[i].start);
+    state->maxEnd = fmax(state->maxEnd, nodes[i].start + nodes[i].width);
+  }
+  qsort(keys, count, sizeof(FlameSortKey), flameCompare);
+  for (int32_t i = 0; i < count; i++) state->order[i] = keys[i].node;
+  free(keys);
+
+  state->depthStarts = (int32_t *)calloc(state->depthCount + 1, sizeof(int32_t));
+  for (int32_t i = 0; i < count; i++) {
+    const FlameNode *node = &nodes[state->order[i]];
+    state->starts[i] = node->start;
+    state->ends[i] = node->start + node->width;
+    state->depthStarts[node->depth + 1] = i + 1;
+  }
+  // Depths without nodes are empty ranges
+  for (int32_t depth = 1; depth <= state->depthCount; depth++) {
+    state->depthStarts[depth] = CLAY__MAX(state->depthStarts[depth], state->depthStarts[depth - 1]);
+  }
 }
 
-void ScrollContainerByX(char *containerName, float deltaX) {
-  Clay_ScrollContainerData scrollContainerData = Clay_GetScrollContainerData(Clay__HashString(toClayString(containerName), 0, 0));
-  float newScrollX = scrollContainerData.scrollPosition->x + deltaX;
-  float minScrollX = -fmaxf(0, scrollContainerData.contentDimensions.width - scrollContainerData.scrollContainerDimensions.width);
-  scrollContainerData.scrollPosition->x = fminf(0, fmaxf(newScrollX, minScrollX));
+void FlameGraphFree(FlameGraphState *state) {
+  free(state->order);
+  free(state->starts);
+  free(state->ends);
+  free(state->depthStarts);
+  free(state->blocks);
+  free(state->labelWidths);
+  *state = (FlameGraphState){0};
 }
 
-Clay_String s(const char *msg) {
-  return (Clay_String){
-      .length = strlen(msg),
-      .chars = msg,
-  };
+// First `i` in `[low, high)` with `values[i] > value`, or `>=` when `inclusive`
+static int32_t flameSearch(const double *values, int32_t low, int32_t high, double value, bool inclusive) {
+  while (low < high) {
+    int32_t middle = low + (high - low) / 2;
+    if (inclusive ? values[middle] >= value : values[middle] > value) high = middle;
+    else low = middle + 1;
+  }
+  return low;
 }
 
-void RenderSetup(RenderOptions options, Callback updateCallback, Callback drawCallback) {
-  renderer.totalMemorySize = Clay_MinMemorySize();
-  renderer.clayMemory = Clay_CreateArenaWithCapacityAndMemory(renderer.totalMemorySize, malloc(renderer.totalMemorySize));
-  Clay_Initialize(renderer.clayMemory, (Clay_Dimensions){(float)GetScreenWidth(), (float)GetScreenHeight()}, (Clay_ErrorHandler){HandleClayErrors, 0});
-  Clay_Raylib_Initialize(options.width, options.height, options.windowName, FLAG_VSYNC_HINT | FLAG_WINDOW_RESIZABLE | FLAG_WINDOW_HIGHDPI | FLAG_MSAA_4X_HINT);
+static void flamePushBlock(FlameGraphState *state, int32_t *count, FlameBlock block) {
+  if (*count == state->blockCapacity) {
+    state->blockCapacity = CLAY__MAX(256, state->blockCapacity * 2);
+    state->blocks = (FlameBlock *)realloc(state->blocks, sizeof(FlameBlock) * state->blockCapacity);
+  }
+  state->blocks[(*count)++] = block;
+}
 
-  renderer.fonts[FONT_18] = LoadFontEx(options.fontPath, 18, 0, 250);
-  SetTextureFilter(renderer.fonts[FONT_18].texture, TEXTURE_FILTER_BILINEAR);
-  renderer.fonts[FONT_20] = LoadFontEx(options.fontPath, 20, 0, 250);
-  SetTextureFilter(renderer.fonts[FONT_20].texture, TEXTURE_FILTER_BILINEAR);
-  renderer.fonts[FONT_22] = LoadFontEx(options.fontPath, 22, 0, 250);
-  SetTextureFilter(renderer.fonts[FONT_22].texture, TEXTURE_FILTER_BILINEAR);
-  renderer.fonts[FONT_24] = LoadFontEx(options.fontPath, 24, 0, 250);
-  SetTextureFilter(renderer.fonts[FONT_24].texture, TEXTURE_FILTER_BILINEAR);
+static Color flameColor(int32_t label) {
+  // Warm colors that stay the same for a function across frames
+  uint32_t hash = (uint32_t)label * 2654435761u;
+  return (Color){(uint8_t)(205 + (hash >> 8) % 50), (uint8_t)(80 + (hash >> 16) % 120), (uint8_t)(30 + (hash >> 24) % 40), 255};
+}
 
-  // GenTextureMipmaps(&renderer.font[FONT_24].texture);
-  Clay_SetMeasureTextFunction(Raylib_MeasureText, &renderer.fonts);
-  while (!renderer.shouldClose) {
-    if (IsKeyPressed(KEY_ESCAPE) || WindowShouldClose()) renderer.shouldClose = true;
+void FlameGraphDeclare(FlameGraphOptions options) {
+  assert(options.id && options.state && "FlameGraph needs an id and a state");
+  FlameGraphState *state = options.state;
+  if (!options.rowHeight) options.rowHeight = 18;
+  if (!options.fontSize) options.fontSize = 14;
+  if (!options.aggregateColor.a) options.aggregateColor = (Color){150, 150, 150, 255};
+  if (options.from == 0 && options.to == 0) {
+    options.from = state->minStart;
+    options.to = state->maxEnd;
+  }
 
-    if (renderer.reinitialize) {
-      Clay_SetMaxElementCount(8192);
-      renderer.totalMemorySize = Clay_MinMemorySize();
-      renderer.clayMemory = Clay_CreateArenaWithCapacityAndMemory(renderer.totalMemorySize, malloc(renderer.totalMemorySize));
-      Clay_Initialize(renderer.clayMemory, (Clay_Dimensions){(float)GetScreenWidth(), (float)GetScreenHeight()}, (Clay_ErrorHandler){HandleClayErrors, 0});
-      renderer.reinitialize = false;
+  CustomLayoutElement *element = (CustomLayoutElement *)ArenaAlloc(&renderer.frameArena, sizeof(CustomLayoutElement));
+  element->type = CUSTOM_LAYOUT_ELEMENT_TYPE_FLAME_GRAPH;
+  CustomLayoutElement_FlameGraph *graph = &element->customData.flameGraph;
+  *graph = (CustomLayoutElement_FlameGraph){.textColor = options.textColor, .fontId = options.fontId, .fontSize = options.fontSize};
+  Clay_ElementDeclaration declaration = ParseComponentOptions(COMPONENT_OPTIONS(.id = options.id, .w = options.w, .bg = options.bg), boxDefaultOptions);
+  declaration.layout.sizing.height = CLAY_SIZING_FIXED(state->depthCount * options.rowHeight);
+  declaration.custom.customData = element;
+
+  float width = CanvasSize(options.id).x;
+  if (width < 1 || state->count == 0 || options.to <= options.from) {
+    CLAY(declaration) {}
+    return;
+  }
+
+  if (state->labelWidthLabels != options.labels || state->labelWidthCount != options.labelCount || state->labelFontId != options.fontId || state->labelFontSize != options.fontSize) {
+    state->labelWidths = (float *)realloc(state->labelWidths, sizeof(float) * CLAY__MAX(options.labelCount, 1));
+    for (int32_t i = 0; i < options.labelCount; i++) state->labelWidths[i] = -1;
+    state->labelWidthLabels = options.labels;
+    state->labelWidthCount = options.labelCount;
+    state->labelFontId = options.fontId;
+    state->labelFontSize = options.fontSize;
+  }
+
+  double scale = width / (options.to - options.from);
+  int32_t blockCount = 0;
+  for (int32_t depth = 0; depth < state->depthCount; depth++) {
+    int32_t high = state->depthStarts[depth + 1];
+    int32_t i = flameSearch(state->ends, state->depthStarts[depth], high, options.from, false);
+    // Aggregate being grown, flushed once something is more than a pixel past it
+    FlameBlock pending = {.x1 = -INFINITY, .depth = depth, .node = -1};
+    while (i < high && state->starts[i] < options.to) {
+      float x0 = (float)((state->starts[i] - options.from) * scale);
+      float x1 = (float)((state->ends[i] - options.from) * scale);
+      if (x1 - x0 >= 1) {
+        if (pending.x1 > pending.x0) flamePushBlock(state, &blockCount, pending);
+        pending.x1 = -INFINITY;
+        flamePushBlock(state, &blockCount, (FlameBlock){fmaxf(x0, 0), fminf(x1, width), depth, state->order[i]});
+        i++;
+        continue;
+      }
+
+      // Everything else starting in this pixel column joins the aggregate, except a wide node which is drawn itself
+      int32_t next = flameSearch(state->starts, i + 1, high, options.from + (floorf(x0) + 1) / scale, true);
+      if (next - 1 > i && (state->ends[next - 1] - state->starts[next - 1]) * scale >= 1) next--;
+      float end = fmaxf((float)((state->ends[next - 1] - options.from) * scale), x0 + 1);
+      if (x0 <= pending.x1 + 1) {
+        pending.x1 = fminf(fmaxf(pending.x1, end), width);
+      } else {
+        if (pending.x1 > pending.x0) flamePushBlock(state, &blockCount, pending);
+        pending.x0 = fmaxf(x0, 0);
+        pending.x1 = fminf(end, width);
+      }
+      i = next;
     }
+    if (pending.x1 > pending.x0) flamePushBlock(state, &blockCount, pending);
+  }
 
-    initDraw();
-    updateCallback();
-    drawCallback();
+  graph->blocks = CanvasBatchAlloc(CANVAS_TRIANGLES, 4 * blockCount, 6 * blockCount);
+  graph->labels = (FlameLabel *)ArenaAlloc(&renderer.frameArena, sizeof(FlameLabel) * CLAY__MAX(blockCount, 1));
+  float padding = 4;
+  for (int32_t i = 0; i < blockCount; i++) {
+    FlameBlock block = state->blocks[i];
+    int32_t label = block.node < 0 ? -1 : state->nodes[block.node].label;
+    Color color = block.node < 0 ? options.aggregateColor : flameColor(label);
+    // Leave a pixel between neighbors and rows where there's room for it
+    float right = block.x1 - block.x0 >= 3 ? block.x1 - 1 : block.x1;
+    float top = block.depth * options.rowHeight;
+    float bottom = top + options.rowHeight - 1;
+    uint32_t first = CanvasVertices(graph->blocks, (CanvasVertex[]){{block.x0, top, color}, {block.x0, bottom, color}, {right, bottom, color}, {right, top, color}}, 4);
+    CanvasIndices(graph->blocks, (uint32_t[]){first, first + 1, first + 2, first, first + 2, first + 3}, 6);
+
+    if (label < 0 || label >= options.labelCount || right - block.x0 < 2 * padding) continue;
+    if (state->labelWidths[label] < 0) {
+      Clay_String text = options.labels[label];
+      state->labelWidths[label] = measureLineWidth(renderer.fonts, options.fontId, options.fontSize, text.chars, text.length);
+    }
+    if (state->labelWidths[label] + 2 * padding > right - block.x0) continue;
+    graph->labels[graph->labelCount++] = (FlameLabel){block.x0 + padding, top + (options.rowHeight - options.fontSize) / 2, options.labels[label]};
   }
+  CLAY(declaration) {}
+}
 
-  CloseWindow();
+void GlyphGridDeclare(GlyphGridState *state) {
+  // Cell size needs the fonts, which are only loaded once the renderer is set up
+  if (state->cellWidth == 0) {
+    Font font = renderer.fonts[state->fontId];
+    state->cellWidth = font.glyphs[GetGlyphIndex(font, 'M')].advanceX * ((float)state->fontSize / font.baseSize);
+    state->cellHeight = state->fontSize;
+    memset(state->dirtyRows, true, state->rows * sizeof(bool));
+  }
+
+  CustomLayoutElement *element = (CustomLayoutElement *)ArenaAlloc(&renderer.frameArena, sizeof(CustomLayoutElement));
+  element->type = CUSTOM_LAYOUT_ELEMENT_TYPE_GLYPH_GRID;
+  element->customData.glyphGrid = state;
+  CLAY(customDeclaration(CLAY_SIZING_FIXED(state->columns * state->cellWidth), CLAY_SIZING_FIXED(state->rows * state->cellHeight), element)) {}
 }
 
-Clay_String F(Arena *arena, const char *format, ...) {
-  // Get formatted string size
-  va_list args;
-  va_start(args, format);
-  size_t size = vsnprintf(NULL, 0, format, args) + 1; // +1 for null terminator
-  va_end(args);
+typedef struct {
+  HexViewOptions *options;
+  float advance;
+  int32_t addressDigits;
+  int32_t asciiStart;
+  int32_t rowLength;
+} HexViewLayout;
+
+// Both hex digits of every byte, so encoding a byte is one 2 byte copy
+static char hexLut[256][2];
+
+static void hexLutInit(void) {
+  static const char digits[] = "0123456789abcdef";
+  if (hexLut[255][0]) return;
+  for (int32_t i = 0; i < 256; i++) {
+    hexLut[i][0] = digits[i >> 4];
+    hexLut[i][1] = digits[i & 15];
+  }
+}
 
-  // Allocate based on size
-  char *buffer = (char *)ArenaAlloc(arena, size);
-  va_start(args, format);
-  vsnprintf(buffer, size, format, args);
-  va_end(args);
+static Clay_Color hexViewByteColor(HexViewOptions *options, uint8_t byte) {
+  if (byte == 0) return options->zeroColor;
+  if (byte >= 0x80) return options->highColor;
+  if (byte < 0x20 || byte == 0x7f) return options->controlColor;
+  return options->printableColor;
+}
 
-  return (Clay_String){.length = size - 1, .chars = buffer};
+// Appends `[start, end)` with `color`, merging it into the previous span when the color is the same
+static void hexViewSpan(CustomLayoutElement_TextSpans *text, HexViewOptions *options, int32_t start, int32_t end, Clay_Color color) {
+  if (text->spanCount > 0) {
+    TextSpan *last = &text->spans[text->spanCount - 1];
+    if (memcmp(&last->color, &color, sizeof(Clay_Color)) == 0) {
+      last->length = end - last->start;
+      return;
+    }
+  }
+  text->spans[text->spanCount++] = (TextSpan){.start = start, .length = end - start, .color = color, .fontId = options->fontId, .fontSize = options->fontSize};
+}
+
+static void hexViewRow(int32_t row, void *userData) {
+  HexViewLayout *layout = (HexViewLayout *)userData;
+  HexViewOptions *options = layout->options;
+  size_t offset = (size_t)row * options->bytesPerRow;
+  int32_t count = (int32_t)CLAY__MIN((size_t)options->bytesPerRow, options->size - offset);
+  const uint8_t *bytes = options->data + offset;
+
+  CustomLayoutElement *element = (CustomLayoutElement *)ArenaAlloc(&renderer.frameArena, sizeof(CustomLayoutElement));
+  CustomLayoutElement_TextSpans *text = &element->customData.textSpans;
+  char *chars = (char *)ArenaAlloc(&renderer.frameArena, layout->rowLength);
+  element->type = CUSTOM_LAYOUT_ELEMENT_TYPE_TEXT_SPANS;
+  *text = (CustomLayoutElement_TextSpans){
+      .chars = chars,
+      .length = layout->rowLength,
+      .spans = (TextSpan *)ArenaAlloc(&renderer.frameArena, sizeof(TextSpan) * (1 + 2 * count)),
+      .advance = layout->advance,
+      .height = options->fontSize,
+  };
+  memset(chars, ' ', layout->rowLength);
+
+  uint64_t address = options->baseAddress + offset;
+  for (int32_t i = layout->addressDigits / 2 - 1; i >= 0; i--, address >>= 8) {
+    memcpy(chars + i * 2, hexLut[address & 0xff], 2);
+  }
+  hexViewSpan(text, options, 0, layout->addressDigits, options->addressColor);
+
+  int32_t column = layout->addressDigits + 2;
+  for (int32_t i = 0; i < count; i++) {
+    if (i > 0 && i % 8 == 0) column++;
+    memcpy(chars + column, hexLut[bytes[i]], 2);
+    hexViewSpan(text, options, column, column + 2, hexViewByteColor(options, bytes[i]));
+    column += 3;
+  }
+
+  for (int32_t i = 0; i < count; i++) {
+    int32_t at = layout->asciiStart + i;
+    chars[at] = bytes[i] >= 0x20 && bytes[i] < 0x7f ? (char)bytes[i] : '.';
+    hexViewSpan(text, options, at, at + 1, hexViewByteColor(options, bytes[i]));
+  }
+
+  CLAY(customDeclaration(CLAY_SIZING_FIXED(layout->rowLength * layout->advance), CLAY_SIZING_FIXED(options->rowHeight), element)) {}
+}
+
+void HexViewDeclare(HexViewOptions options) {
+  if (!options.bytesPerRow) options.bytesPerRow = 16;
+  if (!options.rowHeight) options.rowHeight = options.fontSize + 4;
+  if (!options.addressColor.a) options.addressColor = (Clay_Color){140, 140, 140, 255};
+  if (!options.zeroColor.a) options.zeroColor = (Clay_Color){90, 90, 90, 255};
+  if (!options.printableColor.a) options.printableColor = (Clay_Color){235, 235, 235, 255};
+  if (!options.controlColor.a) options.controlColor = (Clay_Color){180, 180, 180, 255};
+  if (!options.highColor.a) options.highColor = (Clay_Color){200, 200, 200, 255};
+  hexLutInit();
+
+  // Addresses get 8 digits unless the last one needs all 16
+  HexViewLayout layout = {.options = &options};
+  layout.addressDigits = options.baseAddress + options.size > 0xffffffffull ? 16 : 8;
+  layout.asciiStart = layout.addressDigits + 2 + options.bytesPerRow * 3 + (options.bytesPerRow - 1) / 8 + 1;
+  layout.rowLength = layout.asciiStart + options.bytesPerRow;
+  layout.advance = MeasureTextEx(renderer.fonts[options.fontId], "0", options.fontSize, 0).x;
+
+  int32_t rowCount = (int32_t)((options.size + options.bytesPerRow - 1) / options.bytesPerRow);
+  VirtualList(.id = options.id,
+              .w = options.w,
+              .h = options.h,
+              .bg = options.bg,
+              .rowCount = rowCount,
+              .rowHeight = options.rowHeight,
+              .onRow = hexViewRow,
+              .userData = &layout);
 }
 
 static Clay_ElementDeclaration ParseComponentOptions(ComponentOptions options, Clay_ElementDeclaration defaultOptions) {
@@ -878,6 +6048,12 @@ static Clay_ElementDeclaration ParseComponentOptions(ComponentOptions options, C
     if (options.gap) {
       result.layout.childGap = options.gap;
     }
+
+#ifdef RENDERER_ATTRIBUTION
+    AttributionEntry *entry = attributionCurrent();
+    entry->elements++;
+    result.userData = entry;
+#endif
   }
 
   // Padding parse
@@ -1184,6 +6360,7 @@ void *ArenaAlloc(Arena *a, const size_t size) {
   offset -= (intptr_t)a->buffer; // Change to relative offset
 
   assert(offset + size <= a->bufferLength && "Arena ran out of space left");
+  RENDERER_PROBE2(arena_alloc, size, offset + size);
 
   void *ptr = &a->buffer[offset];
   a->prevOffset = offset;
@@ -1210,4 +6387,105 @@ Arena ArenaInit(size_t size) {
       .currOffset = 0,
   };
 }
+
+/* HDR style histogram, inspired from:
+   https://github.com/HdrHistogram/HdrHistogram_c
+*/
+static int32_t histogramIndex(uint32_t value) {
+  if (value < HISTOGRAM_SUB_BUCKETS) return (int32_t)value;
+
+  // Keep the top HISTOGRAM_SUB_BUCKET_BITS bits, the rest of the value only picks the power of two
+  int32_t highestBit = 31;
+  while (!(value & (1u << highestBit))) highestBit--;
+  int32_t shift = highestBit - (HISTOGRAM_SUB_BUCKET_BITS - 1);
+  int32_t subBucket = (int32_t)(value >> shift) - HISTOGRAM_HALF_SUB_BUCKETS;
+  return HISTOGRAM_SUB_BUCKETS + (shift - 1) * HISTOGRAM_HALF_SUB_BUCKETS + subBucket;
+}
+
+// Highest value that lands in bucket `index`
+static uint32_t histogramValue(int32_t index) {
+  if (index < HISTOGRAM_SUB_BUCKETS) return (uint32_t)index;
+
+  int32_t shift = (index - HISTOGRAM_SUB_BUCKETS) / HISTOGRAM_HALF_SUB_BUCKETS + 1;
+  uint64_t subBucket = (uint64_t)((index - HISTOGRAM_SUB_BUCKETS) % HISTOGRAM_HALF_SUB_BUCKETS + HISTOGRAM_HALF_SUB_BUCKETS);
+  return (uint32_t)(((subBucket + 1) << shift) - 1);
+}
+
+void HistogramRecord(Histogram *histogram, uint32_t value) {
+  histogram->counts[histogramIndex(value)]++;
+  histogram->total++;
+  if (value > histogram->max) histogram->max = value;
+}
+
+uint32_t HistogramPercentile(Histogram *histogram, double percentile) {
+  if (histogram->total == 0) return 0;
+
+  uint64_t target = (uint64_t)ceil(percentile / 100.0 * (double)histogram->total);
+  if (target == 0) target = 1;
+
+  uint64_t seen = 0;
+  for (int32_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+    seen += histogram->counts[i];
+    if (seen >= target) return CLAY__MIN(histogramValue(i), histogram->max);
+  }
+  return histogram->max;
+}
+
+void HistogramReset(Histogram *histogram) {
+  memset(histogram, 0, sizeof(*histogram));
+}
+
+/* Frame stats */
+static const char *renderPhaseNames[RENDER_PHASE_COUNT] = {"frame", "update", "draw", "layout", "render"};
+
+FrameStats GetFrameStats(RenderPhase phase) {
+  Histogram *histogram = &renderer.phases[phase];
+  return (FrameStats){
+      .count = histogram->total,
+      .p50 = HistogramPercentile(histogram, 50) / 1000.0,
+      .p90 = HistogramPercentile(histogram, 90) / 1000.0,
+      .p99 = HistogramPercentile(histogram, 99) / 1000.0,
+      .max = histogram->max / 1000.0,
+  };
+}
+
+void ResetFrameStats(void) {
+  for (int32_t i = 0; i < RENDER_PHASE_COUNT; i++) {
+    HistogramReset(&renderer.phases[i]);
+  }
+}
+
+bool ExportFrameStats(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (!file) return false;
+
+  size_t pathLen = strlen(path);
+  bool json = pathLen >= 5 && strcmp(path + pathLen - 5, ".json") == 0;
+  if (json) {
+    fprintf(file, "{\n");
+  } else {
+    fprintf(file, "phase,count,p50_ms,p90_ms,p99_ms,max_ms\n");
+  }
+
+  for (int32_t i = 0; i < RENDER_PHASE_COUNT; i++) {
+    FrameStats stats = GetFrameStats((RenderPhase)i);
+    if (json) {
+      fprintf(file,
+              "  \"%s\": {\"count\": %llu, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}%s\n",
+              renderPhaseNames[i],
+              (unsigned long long)stats.count,
+              stats.p50,
+              stats.p90,
+              stats.p99,
+              stats.max,
+              i + 1 < RENDER_PHASE_COUNT ? "," : "");
+    } else {
+      fprintf(file, "%s,%llu,%.3f,%.3f,%.3f,%.3f\n", renderPhaseNames[i], (unsigned long long)stats.count, stats.p50, stats.p90, stats.p99, stats.max);
+    }
+  }
+
+  if (json) fprintf(file, "}\n");
+  fclose(file);
+  return true;
+}
 #endif